@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "Optional.h"
+
+namespace util {
+
+// Does not own the description string.
+class ParseError : public std::exception {
+public:
+	ParseError(const char* description) noexcept
+		: m_description(description) {
+	}
+
+	const char* what() const noexcept override final {
+		return m_description;
+	}
+
+private:
+	const char* m_description;
+};
+
+namespace details {
+
+// Returns the first occurrence of c in [first, last), or last.
+inline const char* findByte(const char* first, const char* last, char c) noexcept {
+#if defined(__SSE2__)
+	const __m128i needle = _mm_set1_epi8(c);
+	for (; last - first >= 16; first += 16) {
+		const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+		const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+		if (mask)
+			return first + countTrailingZeros(mask);
+	}
+#endif
+	for (; first != last; ++first) {
+		if (*first == c)
+			return first;
+	}
+	return last;
+}
+
+inline void parseValue(const char* first, const char* last, Optional<std::int64_t>& out) {
+	if (first == last)
+		return;
+	const bool negative = *first == '-';
+	if (negative || *first == '+')
+		++first;
+	if (first == last)
+		throw ParseError("Expected digits in integer field");
+	// Accumulate towards the negative end, which can hold the minimum value.
+	constexpr std::int64_t MIN = std::numeric_limits<std::int64_t>::min();
+	std::int64_t value = 0;
+	for (; first != last; ++first) {
+		const unsigned digit = static_cast<unsigned char>(*first) - unsigned('0');
+		if (digit > 9)
+			throw ParseError("Invalid character in integer field");
+		if (value < (MIN + std::int64_t(digit)) / 10)
+			throw ParseError("Integer field out of range");
+		value = value * 10 - std::int64_t(digit);
+	}
+	if (!negative) {
+		if (value == MIN)
+			throw ParseError("Integer field out of range");
+		value = -value;
+	}
+	out = value;
+}
+
+// Converts an unsigned decimal already checked by parseValue. strtod needs a
+// terminated string in the current locale, so the field is copied to the
+// stack with '.' replaced by the locale's decimal point; no cell allocates.
+inline double strtodDecimal(const char* first, const char* last) {
+	const char* decimalPoint = std::localeconv()->decimal_point;
+	const std::size_t pointLength = std::strlen(decimalPoint);
+	char buffer[64];
+	char* end = buffer;
+	for (; first != last; ++first) {
+		const std::size_t length = *first == '.' ? pointLength : 1;
+		if (static_cast<std::size_t>(buffer + sizeof(buffer) - end) <= length)
+			throw ParseError("Floating point field too long");
+		if (*first == '.')
+			end = std::copy(decimalPoint, decimalPoint + pointLength, end);
+		else
+			*end++ = *first;
+	}
+	*end = '\0';
+	char* parsed;
+	const double value = std::strtod(buffer, &parsed);
+	if (parsed != end)
+		throw ParseError("Invalid floating point field");
+	if (value == HUGE_VAL)
+		throw ParseError("Floating point field out of range");
+	return value;
+}
+
+// Accepts only [+-]digits[.digits][(e|E)[+-]digits], so that the result does
+// not depend on the locale and no column type accepts whitespace, hex,
+// infinities or NaNs. Up to 19 significant digits with a small power of ten
+// are converted exactly with one multiplication or division; anything else
+// goes through strtodDecimal.
+inline void parseValue(const char* first, const char* last, Optional<double>& out) {
+	if (first == last)
+		return;
+	const char* const begin = first;
+	const bool negative = *first == '-';
+	if (negative || *first == '+')
+		++first;
+	constexpr int MAX_DIGITS = 19;
+	std::uint64_t mantissa = 0;
+	int significantDigits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	const auto accumulate = [&](unsigned digit, bool fraction) {
+		hasDigits = true;
+		if (mantissa == 0 && digit == 0) {
+			exponent -= fraction;
+			return;
+		}
+		if (significantDigits == MAX_DIGITS) {
+			++significantDigits;
+			return;
+		}
+		if (significantDigits < MAX_DIGITS) {
+			mantissa = mantissa * 10 + digit;
+			++significantDigits;
+			exponent -= fraction;
+		}
+	};
+	for (; first != last && unsigned(*first - '0') <= 9; ++first)
+		accumulate(unsigned(*first - '0'), false);
+	if (first != last && *first == '.') {
+		for (++first; first != last && unsigned(*first - '0') <= 9; ++first)
+			accumulate(unsigned(*first - '0'), true);
+	}
+	if (!hasDigits)
+		throw ParseError("Expected digits in floating point field");
+	if (first != last && (*first == 'e' || *first == 'E')) {
+		++first;
+		const bool negativeExponent = first != last && *first == '-';
+		if (first != last && (*first == '-' || *first == '+'))
+			++first;
+		if (first == last)
+			throw ParseError("Expected digits in floating point exponent");
+		int written = 0;
+		for (; first != last && unsigned(*first - '0') <= 9; ++first) {
+			if (written < 100000)
+				written = written * 10 + (*first - '0');
+		}
+		exponent += negativeExponent ? -written : written;
+	}
+	if (first != last)
+		throw ParseError("Invalid character in floating point field");
+
+	static constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11
+		, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	constexpr std::uint64_t MAX_EXACT = std::uint64_t(1) << 53;
+	double value;
+	if (mantissa == 0)
+		value = 0.0;
+	else if (significantDigits <= MAX_DIGITS && mantissa <= MAX_EXACT && exponent >= -22 && exponent <= 22) {
+		value = static_cast<double>(mantissa);
+		value = exponent < 0 ? value / POW10[-exponent] : value * POW10[exponent];
+	}
+	else
+		value = strtodDecimal(negative || *begin == '+' ? begin + 1 : begin, last);
+	out = negative ? -value : value;
+}
+
+} // namespace details
+
+// Decodes newline separated records with a fixed number of delimited fields
+// into one column of Optional<Column> per field, where an empty field is
+// absent. Input may be fed in chunks of any size; a record split between
+// chunks is carried over to the next one. Quoting is not supported.
+//
+// A malformed record is skipped. The rest of its chunk is still parsed,
+// including a trailing partial record, and then ParseError is thrown for the
+// first malformed record, so feeding can resume with the next chunk.
+//
+// Columns keep their capacity across clearColumns(), so a caller that drains
+// the columns after every chunk parses without allocating per cell.
+template <typename... Columns>
+class DelimitedParser {
+	static_assert(sizeof...(Columns) > 0, "util::DelimitedParser needs at least one column");
+
+public:
+	static constexpr std::size_t COLUMN_COUNT = sizeof...(Columns);
+
+	explicit DelimitedParser(char delimiter = ',')
+		: m_delimiter(delimiter) {
+	}
+
+	void feed(const char* data, std::size_t size) {
+		const char* last = data + size;
+		const char* error = nullptr;
+		if (!m_carry.empty()) {
+			const char* newline = details::findByte(data, last, '\n');
+			m_carry.append(data, newline);
+			if (newline == last)
+				return;
+			parseRecord(m_carry.data(), m_carry.data() + m_carry.size(), error);
+			m_carry.clear();
+			data = newline + 1;
+		}
+		for (;;) {
+			const char* newline = details::findByte(data, last, '\n');
+			if (newline == last) {
+				m_carry.assign(data, last);
+				break;
+			}
+			parseRecord(data, newline, error);
+			data = newline + 1;
+		}
+		if (error)
+			throw ParseError(error);
+	}
+
+	// Parses a final record that is not terminated by a newline.
+	void finish() {
+		if (m_carry.empty())
+			return;
+		try {
+			parseRecord(m_carry.data(), m_carry.data() + m_carry.size());
+		}
+		catch (...) {
+			m_carry.clear();
+			throw;
+		}
+		m_carry.clear();
+	}
+
+	template <std::size_t I>
+	std::vector<Optional<std::tuple_element_t<I, std::tuple<Columns...>>>>& column() noexcept {
+		return std::get<I>(m_columns);
+	}
+
+	template <std::size_t I>
+	const std::vector<Optional<std::tuple_element_t<I, std::tuple<Columns...>>>>& column() const noexcept {
+		return std::get<I>(m_columns);
+	}
+
+	std::size_t rows() const noexcept {
+		return std::get<0>(m_columns).size();
+	}
+
+	void reserve(std::size_t rows) {
+		forEachColumn([rows](auto& column) { column.reserve(rows); });
+	}
+
+	void clearColumns() noexcept {
+		forEachColumn([](auto& column) { column.clear(); });
+	}
+
+private:
+	using Indices = std::index_sequence_for<Columns...>;
+	using Row = std::tuple<Optional<Columns>...>;
+
+	template <typename F>
+	void forEachColumn(F&& f) {
+		forEachColumn(std::forward<F>(f), Indices{});
+	}
+
+	template <typename F, std::size_t... I>
+	void forEachColumn(F&& f, std::index_sequence<I...>) {
+		using Expand = int[];
+		(void)Expand{0, (f(std::get<I>(m_columns)), 0)...};
+	}
+
+	// Keeps the first error in error instead of throwing it.
+	void parseRecord(const char* first, const char* last, const char*& error) {
+		try {
+			parseRecord(first, last);
+		}
+		catch (const ParseError& e) {
+			if (!error)
+				error = e.what();
+		}
+	}
+
+	// A record is decoded into a row first so that a malformed field leaves
+	// the columns untouched.
+	void parseRecord(const char* first, const char* last) {
+		if (first != last && last[-1] == '\r')
+			--last;
+		Row row;
+		parseRow(first, last, row, Indices{});
+		appendRow(row, Indices{});
+	}
+
+	template <std::size_t... I>
+	void parseRow(const char* first, const char* last, Row& row, std::index_sequence<I...>) {
+		using Expand = int[];
+		(void)Expand{0, (parseField<I>(first, last, row), 0)...};
+	}
+
+	template <std::size_t I>
+	void parseField(const char*& first, const char* last, Row& row) {
+		const char* fieldEnd = details::findByte(first, last, m_delimiter);
+		if (I + 1 < COLUMN_COUNT && fieldEnd == last)
+			throw ParseError("Too few fields in record");
+		if (I + 1 == COLUMN_COUNT && fieldEnd != last)
+			throw ParseError("Too many fields in record");
+		details::parseValue(first, fieldEnd, std::get<I>(row));
+		first = fieldEnd == last ? last : fieldEnd + 1;
+	}
+
+	template <std::size_t... I>
+	void appendRow(Row& row, std::index_sequence<I...>) {
+		using Expand = int[];
+		(void)Expand{0, (std::get<I>(m_columns).push_back(std::move(std::get<I>(row))), 0)...};
+	}
+
+	const char m_delimiter;
+	std::string m_carry;
+	std::tuple<std::vector<Optional<Columns>>...> m_columns;
+};
+
+} // namespace util
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <initializer_list>
 #include <type_traits>
@@ -21,6 +23,12 @@ struct InPlace {
 
 constexpr InPlace inPlace{};
 
+struct FromInvoke {
+    explicit FromInvoke() = default;
+};
+
+constexpr FromInvoke fromInvoke{};
+
 template <typename T>
 class DefaultOptionalPolicy {
 public:
@@ -32,8 +40,12 @@ public:
 		m_initialized = true;
 	}
 
-	constexpr void unset(T&) noexcept {
+	// Arithmetic payloads are zeroed so that the storage of a disengaged
+	// optional never holds indeterminate bytes and can be read without a
+	// branch, see Optional::valueOr.
+	void unset(T& t) noexcept {
 		m_initialized = false;
+		clear(t, std::is_arithmetic<T>{});
 	}
 
 	constexpr void reset(T& t) noexcept {
@@ -42,11 +54,139 @@ public:
 	}
 
 private:
+	static void clear(T& t, std::true_type) noexcept {
+		::new (const_cast<std::remove_const_t<T>*>(&t)) std::remove_const_t<T>();
+	}
+
+	static constexpr void clear(T&, std::false_type) noexcept {
+	}
+
 	bool m_initialized;
 };
 
+// Encodes the disengaged state as SENTINEL inside the payload itself, so it
+// adds no storage. Engaging the optional with SENTINEL makes it look empty.
+template <typename T, T SENTINEL>
+class SentinelOptionalPolicy {
+public:
+	constexpr bool initialized(const T& t) const noexcept {
+		return t != SENTINEL;
+	}
+
+	constexpr void set(T&) noexcept {
+	}
+
+	void unset(T& t) noexcept {
+		::new (const_cast<std::remove_const_t<T>*>(&t)) std::remove_const_t<T>(SENTINEL);
+	}
+
+	void reset(T& t) noexcept {
+		unset(t);
+	}
+};
+
+// A bool only ever holds 0 or 1, so any other byte marks the disengaged state.
+class BoolOptionalPolicy {
+public:
+	bool initialized(const bool& t) const noexcept {
+		unsigned char byte;
+		std::memcpy(&byte, &t, sizeof(byte));
+		return byte != EMPTY;
+	}
+
+	constexpr void set(bool&) noexcept {
+	}
+
+	void unset(bool& t) noexcept {
+		const unsigned char byte = EMPTY;
+		std::memcpy(&t, &byte, sizeof(byte));
+	}
+
+	void reset(bool& t) noexcept {
+		unset(t);
+	}
+
+private:
+	static constexpr unsigned char EMPTY = 0xff;
+};
+
+// Customization point consulted by Optional and makeOptional when no Policy
+// is spelled out. Specialize it for a type with spare representations to get
+// an Optional without the extra flag.
+template <typename T>
+struct OptionalTraits {
+	using Policy = DefaultOptionalPolicy<T>;
+};
+
+template <>
+struct OptionalTraits<bool> {
+	using Policy = BoolOptionalPolicy;
+};
+
+template <typename T, typename Policy = typename OptionalTraits<T>::Policy>
+class Optional;
+
+// Wrap a policy in one of these to tell the compiler which way engagement
+// checks usually go, e.g. Optional<T, LikelyEngaged<DefaultOptionalPolicy<T>>>.
+// Only the layout of branches changes; the wrapped policy is used as is.
+template <typename Policy>
+class LikelyEngaged : public Policy {
+};
+
+template <typename Policy>
+class LikelyEmpty : public Policy {
+};
+
+template <typename T>
+using LikelyEngagedOptional = Optional<T, LikelyEngaged<typename OptionalTraits<T>::Policy>>;
+
+template <typename T>
+using LikelyEmptyOptional = Optional<T, LikelyEmpty<typename OptionalTraits<T>::Policy>>;
+
 namespace details {
 
+template <typename Policy>
+constexpr bool LIKELY_ENGAGED = false;
+
+template <typename Policy>
+constexpr bool LIKELY_ENGAGED<LikelyEngaged<Policy>> = true;
+
+template <typename Policy>
+constexpr bool LIKELY_EMPTY = false;
+
+template <typename Policy>
+constexpr bool LIKELY_EMPTY<LikelyEmpty<Policy>> = true;
+
+template <typename Policy>
+constexpr bool expectEngaged(bool engaged) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return LIKELY_ENGAGED<Policy> ? __builtin_expect(engaged, true)
+		: LIKELY_EMPTY<Policy> ? __builtin_expect(engaged, false)
+		: engaged;
+#else
+	return engaged;
+#endif
+}
+
+// Whether constructing or destroying a payload sits on the side of a branch
+// that the policy hint marks as unlikely. Trivial payloads are left inline,
+// since there a call would cost more than the work it moves away.
+template <typename Policy, typename T>
+constexpr bool COLD_CONSTRUCT = LIKELY_ENGAGED<Policy> && !std::is_trivially_copyable<T>::value;
+
+template <typename Policy, typename T>
+constexpr bool COLD_DESTRUCT = LIKELY_EMPTY<Policy> && !std::is_trivially_destructible<T>::value;
+
+// Calls f from a separate function placed with the cold code, so that the
+// caller's likely path stays short.
+template <typename F>
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((noinline, cold))
+#endif
+void callCold(F&& f) {
+	std::forward<F>(f)();
+}
+
 template <typename T>
 class OptionalStorage {
 public:
@@ -68,7 +208,11 @@ private:
 	std::aligned_storage_t<sizeof(T), alignof(T)> m_data;
 };
 
-template <typename T, typename Policy, bool>
+template <typename T, typename Policy>
+constexpr bool TRIVIALLY_COPYABLE_OPTIONAL = std::is_trivially_copyable<T>::value
+	&& std::is_trivially_copyable<Policy>::value;
+
+template <typename T, typename Policy, bool, bool>
 class OptionalBase : private Policy {
 	using StoredType = std::remove_const_t<T>;
 
@@ -82,17 +226,26 @@ public:
 	}
 
 	template <typename... Args>
-	constexpr explicit OptionalBase(InPlace, Args... args) {
+	constexpr explicit OptionalBase(InPlace, Args&&... args) {
 		construct(std::forward<Args>(args)...);
 	}
 
 	template <typename U, typename... Args
 		, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>, Args&&...>::value, int>...>
-	constexpr explicit OptionalBase(InPlace, std::initializer_list<U> ilist, Args... args) {
+	constexpr explicit OptionalBase(InPlace, std::initializer_list<U> ilist, Args&&... args) {
 		::new (m_storage.data()) StoredType(ilist, std::forward<Args>(args)...);
 		Policy::set(storage());
 	}
 
+	// The result of f is constructed directly in the storage. With the
+	// guaranteed copy elision of C++17, T needs neither a copy nor a move
+	// constructor; before that T must be move constructible, even though the
+	// move is elided in practice.
+	template <typename F, typename... Args>
+	constexpr explicit OptionalBase(FromInvoke, F&& f, Args&&... args) {
+		constructWith(std::forward<F>(f), std::forward<Args>(args)...);
+	}
+
 	constexpr OptionalBase(const OptionalBase& other) {
 		if (other.hasValue())
 			construct(other.storage());
@@ -112,10 +265,10 @@ public:
 			if (hasValue())
 				storage() = other.storage();
 			else
-			construct(other.storage());
+				constructUnlikely(other.storage());
 		}
 		else
-			destruct();
+			reset();
 		return *this;
 	}
 
@@ -124,15 +277,111 @@ public:
 			if (hasValue())
 				storage() = std::move(other.storage());
 			else
-			construct(std::move(other.storage()));
+				constructUnlikely(std::move(other.storage()));
 		}
 		else
-			destruct();
+			reset();
 		return *this;
 	}
 
 	constexpr bool hasValue() const noexcept {
-		return Policy::initialized(storage());
+		return expectEngaged<Policy>(Policy::initialized(storage()));
+	}
+
+	void reset() noexcept {
+		if (hasValue())
+			destruct();
+	}
+
+protected:
+	T& storage() noexcept { return m_storage.ref(); }
+
+	const T& storage() const noexcept { return m_storage.ref(); }
+
+	template <typename... Args>
+	void construct(Args&&... args) noexcept(std::is_nothrow_constructible<StoredType, Args...>::value) {
+		::new (m_storage.data()) StoredType(std::forward<Args>(args)...);
+		Policy::set(storage());
+	}
+
+	template <typename F, typename... Args>
+	void constructWith(F&& f, Args&&... args) {
+		::new (m_storage.data()) StoredType(std::forward<F>(f)(std::forward<Args>(args)...));
+		Policy::set(storage());
+	}
+
+	// Construction into a disengaged optional, which LikelyEngaged marks as
+	// the unlikely case.
+	template <typename... Args>
+	void constructUnlikely(Args&&... args) {
+		constructUnlikelyImpl(std::integral_constant<bool, COLD_CONSTRUCT<Policy, T>>{}, std::forward<Args>(args)...);
+	}
+
+	void destruct() noexcept {
+		Policy::reset(storage());
+	}
+
+private:
+	template <typename... Args>
+	void constructUnlikelyImpl(std::true_type, Args&&... args) {
+		callCold([&] { construct(std::forward<Args>(args)...); });
+	}
+
+	template <typename... Args>
+	void constructUnlikelyImpl(std::false_type, Args&&... args) {
+		construct(std::forward<Args>(args)...);
+	}
+
+	OptionalStorage<StoredType> m_storage;
+};
+
+// Trivially copyable payloads under a trivially copyable policy copy the flag
+// and the payload bytes as they are, which keeps Optional trivially copyable
+// and lets it be passed in registers.
+template <typename T, typename Policy>
+class OptionalBase<T, Policy, true, true> : private Policy {
+	using StoredType = std::remove_const_t<T>;
+
+public:
+	constexpr OptionalBase() noexcept {
+		Policy::unset(storage());
+	}
+
+	constexpr OptionalBase(Nullopt) noexcept
+		: OptionalBase() {
+	}
+
+	template <typename... Args>
+	constexpr explicit OptionalBase(InPlace, Args&&... args) {
+		construct(std::forward<Args>(args)...);
+	}
+
+	template <typename U, typename... Args
+		, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>, Args&&...>::value, int>...>
+	constexpr explicit OptionalBase(InPlace, std::initializer_list<U> ilist, Args&&... args) {
+		::new (m_storage.data()) StoredType(ilist, std::forward<Args>(args)...);
+		Policy::set(storage());
+	}
+
+	// The result of f is constructed directly in the storage. With the
+	// guaranteed copy elision of C++17, T needs neither a copy nor a move
+	// constructor; before that T must be move constructible, even though the
+	// move is elided in practice.
+	template <typename F, typename... Args>
+	constexpr explicit OptionalBase(FromInvoke, F&& f, Args&&... args) {
+		constructWith(std::forward<F>(f), std::forward<Args>(args)...);
+	}
+
+	OptionalBase(const OptionalBase&) = default;
+
+	OptionalBase(OptionalBase&&) = default;
+
+	OptionalBase& operator =(const OptionalBase&) = default;
+
+	OptionalBase& operator =(OptionalBase&&) = default;
+
+	constexpr bool hasValue() const noexcept {
+		return expectEngaged<Policy>(Policy::initialized(storage()));
 	}
 
 	void reset() noexcept {
@@ -151,16 +400,39 @@ protected:
 		Policy::set(storage());
 	}
 
+	template <typename F, typename... Args>
+	void constructWith(F&& f, Args&&... args) {
+		::new (m_storage.data()) StoredType(std::forward<F>(f)(std::forward<Args>(args)...));
+		Policy::set(storage());
+	}
+
+	// Construction into a disengaged optional, which LikelyEngaged marks as
+	// the unlikely case.
+	template <typename... Args>
+	void constructUnlikely(Args&&... args) {
+		constructUnlikelyImpl(std::integral_constant<bool, COLD_CONSTRUCT<Policy, T>>{}, std::forward<Args>(args)...);
+	}
+
 	void destruct() noexcept {
 		Policy::reset(storage());
 	}
 
 private:
+	template <typename... Args>
+	void constructUnlikelyImpl(std::true_type, Args&&... args) {
+		callCold([&] { construct(std::forward<Args>(args)...); });
+	}
+
+	template <typename... Args>
+	void constructUnlikelyImpl(std::false_type, Args&&... args) {
+		construct(std::forward<Args>(args)...);
+	}
+
 	OptionalStorage<StoredType> m_storage;
 };
 
 template <typename T, typename Policy>
-class OptionalBase<T, Policy, false> : private Policy {
+class OptionalBase<T, Policy, false, false> : private Policy {
 	using StoredType = std::remove_const_t<T>;
 
 public:
@@ -173,17 +445,26 @@ public:
 	}
 
 	template <typename... Args>
-	constexpr explicit OptionalBase(InPlace, Args... args) {
+	constexpr explicit OptionalBase(InPlace, Args&&... args) {
 		construct(std::forward<Args>(args)...);
 	}
 
 	template <typename U, typename... Args
 		, std::enable_if_t<std::is_constructible<T, std::initializer_list<U>, Args&&...>::value, int>...>
-	constexpr explicit OptionalBase(InPlace, std::initializer_list<U> ilist, Args... args) {
+	constexpr explicit OptionalBase(InPlace, std::initializer_list<U> ilist, Args&&... args) {
 		::new (m_storage.data()) StoredType(ilist, std::forward<Args>(args)...);
 		Policy::set(storage());
 	}
 
+	// The result of f is constructed directly in the storage. With the
+	// guaranteed copy elision of C++17, T needs neither a copy nor a move
+	// constructor; before that T must be move constructible, even though the
+	// move is elided in practice.
+	template <typename F, typename... Args>
+	constexpr explicit OptionalBase(FromInvoke, F&& f, Args&&... args) {
+		constructWith(std::forward<F>(f), std::forward<Args>(args)...);
+	}
+
 	constexpr OptionalBase(const OptionalBase& other) {
 		if (other.hasValue())
 			construct(other.storage());
@@ -203,10 +484,10 @@ public:
 			if (hasValue())
 				storage() = other.storage();
 			else
-			construct(other.storage());
+				constructUnlikely(other.storage());
 		}
 		else
-			destruct();
+			reset();
 		return *this;
 	}
 
@@ -215,10 +496,10 @@ public:
 			if (hasValue())
 				storage() = std::move(other.storage());
 			else
-			construct(std::move(other.storage()));
+				constructUnlikely(std::move(other.storage()));
 		}
 		else
-			destruct();
+			reset();
 		return *this;
 	}
 
@@ -228,12 +509,12 @@ public:
 	}
 
 	constexpr bool hasValue() const noexcept {
-		return Policy::initialized(storage());
+		return expectEngaged<Policy>(Policy::initialized(storage()));
 	}
 
 	void reset() noexcept {
 		if (hasValue())
-			destruct();
+			destructUnlikely();
 	}
 
 protected:
@@ -247,14 +528,156 @@ protected:
 		Policy::set(storage());
 	}
 
+	template <typename F, typename... Args>
+	void constructWith(F&& f, Args&&... args) {
+		::new (m_storage.data()) StoredType(std::forward<F>(f)(std::forward<Args>(args)...));
+		Policy::set(storage());
+	}
+
+	// Construction into a disengaged optional, which LikelyEngaged marks as
+	// the unlikely case.
+	template <typename... Args>
+	void constructUnlikely(Args&&... args) {
+		constructUnlikelyImpl(std::integral_constant<bool, COLD_CONSTRUCT<Policy, T>>{}, std::forward<Args>(args)...);
+	}
+
 	void destruct() noexcept {
 		Policy::reset(storage());
 	}
 
 private:
+	template <typename... Args>
+	void constructUnlikelyImpl(std::true_type, Args&&... args) {
+		callCold([&] { construct(std::forward<Args>(args)...); });
+	}
+
+	template <typename... Args>
+	void constructUnlikelyImpl(std::false_type, Args&&... args) {
+		construct(std::forward<Args>(args)...);
+	}
+
+	// Destruction of an engaged payload, which LikelyEmpty marks as the
+	// unlikely case.
+	void destructUnlikely() noexcept {
+		destructUnlikelyImpl(std::integral_constant<bool, COLD_DESTRUCT<Policy, T>>{});
+	}
+
+	void destructUnlikelyImpl(std::true_type) noexcept {
+		callCold([this] { destruct(); });
+	}
+
+	void destructUnlikelyImpl(std::false_type) noexcept {
+		destruct();
+	}
+
 	OptionalStorage<StoredType> m_storage;
 };
 
+template <std::size_t SIZE>
+struct UnsignedOfSize;
+
+template <>
+struct UnsignedOfSize<1> { using Type = std::uint8_t; };
+
+template <>
+struct UnsignedOfSize<2> { using Type = std::uint16_t; };
+
+template <>
+struct UnsignedOfSize<4> { using Type = std::uint32_t; };
+
+template <>
+struct UnsignedOfSize<8> { using Type = std::uint64_t; };
+
+template <typename T>
+constexpr bool BRANCHLESS_SELECTABLE = std::is_arithmetic<T>::value
+	&& (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+// Integers other than bool are masked as values, which keeps select usable in
+// constant expressions. bool and floating point payloads are masked through
+// their object representations instead.
+template <typename T>
+constexpr bool SELECTABLE_AS_VALUE = BRANCHLESS_SELECTABLE<T>
+	&& std::is_integral<T>::value && !std::is_same<T, bool>::value;
+
+// Whether the payload of a disengaged optional always holds a determinate
+// value of its type, so that it may be read before checking engagement.
+// Specialize for a policy that guarantees this to let Optional::valueOr pick
+// the value without a branch.
+template <typename Policy>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD = false;
+
+template <typename T>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD<DefaultOptionalPolicy<T>> = std::is_arithmetic<T>::value;
+
+template <typename T, T SENTINEL>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD<SentinelOptionalPolicy<T, SENTINEL>> = true;
+
+template <>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD<BoolOptionalPolicy> = true;
+
+template <typename Policy>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD<LikelyEngaged<Policy>> = DETERMINATE_EMPTY_PAYLOAD<Policy>;
+
+template <typename Policy>
+constexpr bool DETERMINATE_EMPTY_PAYLOAD<LikelyEmpty<Policy>> = DETERMINATE_EMPTY_PAYLOAD<Policy>;
+
+// Picks a or b by masking them so that the compiler cannot turn the choice
+// back into a conditional jump. Both operands are read, so each must hold a
+// determinate value.
+template <typename T, std::enable_if_t<SELECTABLE_AS_VALUE<T>, int> = 0>
+constexpr T select(bool condition, const T& a, const T& b) noexcept {
+	using Bits = typename UnsignedOfSize<sizeof(T)>::Type;
+	const Bits mask = static_cast<Bits>(-static_cast<Bits>(condition));
+	return static_cast<T>((static_cast<Bits>(a) & mask) | (static_cast<Bits>(b) & static_cast<Bits>(~mask)));
+}
+
+// The disengaged bool of BoolOptionalPolicy is not a valid bool value, so
+// bools are only ever touched as bytes here.
+template <typename T, std::enable_if_t<BRANCHLESS_SELECTABLE<T> && !SELECTABLE_AS_VALUE<T>, int> = 0>
+inline T select(bool condition, const T& a, const T& b) noexcept {
+	using Bits = typename UnsignedOfSize<sizeof(T)>::Type;
+	Bits aBits;
+	Bits bBits;
+	std::memcpy(&aBits, &a, sizeof(T));
+	std::memcpy(&bBits, &b, sizeof(T));
+	const Bits mask = static_cast<Bits>(-static_cast<Bits>(condition));
+	const Bits bits = static_cast<Bits>((aBits & mask) | (bBits & static_cast<Bits>(~mask)));
+	T result;
+	std::memcpy(&result, &bits, sizeof(T));
+	return result;
+}
+
+template <typename T, std::enable_if_t<!BRANCHLESS_SELECTABLE<T>, int> = 0>
+constexpr T select(bool condition, const T& a, const T& b) {
+	return condition ? a : b;
+}
+
+inline unsigned countTrailingZeros(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+	return static_cast<unsigned>(__builtin_ctzll(word));
+#else
+	unsigned count = 0;
+	while (!(word & 1)) {
+		word >>= 1;
+		++count;
+	}
+	return count;
+#endif
+}
+
+namespace swapping {
+
+using std::swap;
+
+template <typename T>
+constexpr bool IS_NOTHROW_SWAPPABLE = noexcept(swap(std::declval<T&>(), std::declval<T&>()));
+
+} // namespace swapping
+
+// std::is_nothrow_swappable is C++17.
+template <typename T>
+constexpr bool IS_NOTHROW_SWAPPABLE = swapping::IS_NOTHROW_SWAPPABLE<T>;
+
 template <typename T>
 using OptionalEnableCopyMove = EnableCopyMove<std::is_copy_constructible<T>::value
 	, std::is_copy_constructible<T>::value && std::is_copy_assignable<T>::value
@@ -262,13 +685,6 @@ using OptionalEnableCopyMove = EnableCopyMove<std::is_copy_constructible<T>::val
 	, std::is_move_constructible<T>::value && std::is_move_assignable<T>::value
 	, T>;
 
-} // namespace details
-
-template <typename T, typename Policy>
-class Optional;
-
-namespace details {
-
 template <typename T, typename U, typename Policy>
 constexpr bool CONVERTS_FROM_OPTIONAL
 	= std::is_constructible<T, const util::Optional<U, Policy>&>::value
@@ -304,14 +720,31 @@ private:
 	const char* m_description;
 };
 
-template <typename T, typename Policy = DefaultOptionalPolicy<T>>
-class Optional : public details::OptionalBase<T, Policy, std::is_trivially_destructible<T>::value>
+namespace details {
+
+// Kept out of line so that value() inlines to a check and a load.
+#if defined(__GNUC__) || defined(__clang__)
+[[noreturn]] __attribute__((noinline, cold))
+#else
+[[noreturn]]
+#endif
+inline void throwBadOptionalAccess() {
+	throw BadOptionalAccess("Attempt to access value of a disengaged optional object");
+}
+
+} // namespace details
+
+template <typename T, typename Policy>
+class Optional : public details::OptionalBase<T, Policy, std::is_trivially_destructible<T>::value
+		, details::TRIVIALLY_COPYABLE_OPTIONAL<T, Policy>>
 	, private details::OptionalEnableCopyMove<T> {
 	static_assert(!std::is_same<std::remove_cv_t<T>, Nullopt>::value
 		&& !std::is_same<std::remove_cv_t<T>, InPlace>::value
+		&& !std::is_same<std::remove_cv_t<T>, FromInvoke>::value
 		&& !std::is_reference<T>::value, "Invalid instantiation of util::Optional");
 
-	using Base = details::OptionalBase<T, Policy, std::is_trivially_destructible<T>::value>;
+	using Base = details::OptionalBase<T, Policy, std::is_trivially_destructible<T>::value
+		, details::TRIVIALLY_COPYABLE_OPTIONAL<T, Policy>>;
 
 public:
 	using ValueType = T;
@@ -392,10 +825,10 @@ public:
 			if (*this)
 				**this = *other;
 			else
-				this->construct(*other);
+				this->constructUnlikely(*other);
 		}
 		else
-			this->destruct();
+			this->reset();
 		return *this;
 	}
 
@@ -410,10 +843,10 @@ public:
 			if (*this)
 				**this = std::move(*other);
 			else
-				this->construct(std::move(*other));
+				this->constructUnlikely(std::move(*other));
 		}
 		else
-			this->destruct();
+			this->reset();
 		return *this;
 	}
 
@@ -426,7 +859,7 @@ public:
 		if (*this)
 			**this = std::forward<U>(value);
 		else
-			this->construct(std::forward<U>(value));
+			this->constructUnlikely(std::forward<U>(value));
 		return *this;
 	}
 
@@ -461,59 +894,93 @@ public:
 	constexpr T& value() & {
 		return (*this)
 			? **this
-			: throw BadOptionalAccess("Attempt to access value of a "
-				"disengaged optional object");
+			: (details::throwBadOptionalAccess(), **this);
 	}
 
 	constexpr const T& value() const & {
 		return (*this)
 			? **this
-			: (throw BadOptionalAccess("Attempt to access value of a "
-				"disengaged optional object"), **this);
+			: (details::throwBadOptionalAccess(), **this);
 	}
 
 	constexpr T&& value() && {
 		return (*this)
 			? std::move(**this)
-			: (throw BadOptionalAccess("Attempt to access value of a "
-				"disengaged optional object"), std::move(**this));
+			: (details::throwBadOptionalAccess(), std::move(**this));
 	}
 
 	constexpr const T&& value() const && {
 		return (*this)
 			? std::move(**this)
-			: (throw BadOptionalAccess("Attempt to access value of a "
-				"disengaged optional object"), std::move(**this));
+			: (details::throwBadOptionalAccess(), std::move(**this));
 	}
 
 	template <typename U>
 	constexpr T valueOr(U&& defaultValue) const& {
 		static_assert(std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value
 			, "Cannot return value");
-		bool(*this) ? **this : static_cast<T>(std::forward<U>(defaultValue));
+		return valueOrImpl(BranchlessValueOr{}, std::forward<U>(defaultValue));
 	}
 
 	template <typename U>
 	constexpr T valueOr(U&& defaultValue) && {
-		static_assert(std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value
+		static_assert(std::is_move_constructible<T>::value && std::is_convertible<U&&, T>::value
+			, "Cannot return value");
+		return std::move(*this).valueOrImpl(BranchlessValueOr{}, std::forward<U>(defaultValue));
+	}
+
+	constexpr T valueOrDefault() const& {
+		static_assert(std::is_copy_constructible<T>::value && std::is_default_constructible<T>::value
+			, "Cannot return value");
+		return valueOr(T{});
+	}
+
+	constexpr T valueOrDefault() && {
+		static_assert(std::is_move_constructible<T>::value && std::is_default_constructible<T>::value
+			, "Cannot return value");
+		return std::move(*this).valueOr(T{});
+	}
+
+	// f is only invoked when disengaged, so this one keeps its branch.
+	template <typename F>
+	constexpr T valueOrElse(F&& f) const& {
+		static_assert(std::is_copy_constructible<T>::value
+			&& std::is_convertible<decltype(std::forward<F>(f)()), T>::value
 			, "Cannot return value");
-		bool(*this) ? std::move(**this) : static_cast<T>(std::forward<U>(defaultValue));
+		return (*this) ? **this : static_cast<T>(std::forward<F>(f)());
+	}
+
+	template <typename F>
+	constexpr T valueOrElse(F&& f) && {
+		static_assert(std::is_move_constructible<T>::value
+			&& std::is_convertible<decltype(std::forward<F>(f)()), T>::value
+			, "Cannot return value");
+		return (*this) ? std::move(**this) : static_cast<T>(std::forward<F>(f)());
+	}
+
+	// Returns ifEngaged if this holds a value and ifEmpty otherwise. Arithmetic
+	// operands are chosen without a branch.
+	template <typename U>
+	constexpr U select(const U& ifEngaged, const U& ifEmpty) const
+		noexcept(std::is_nothrow_copy_constructible<U>::value) {
+		return details::select(this->hasValue(), ifEngaged, ifEmpty);
 	}
 
 	void swap(Optional& other)
-		noexcept(std::is_nothrow_move_constructible<T>::value) {
-		// TODO: C++17 also add std::is_nothrow_swappable<T>::value)
-		if (other) {
-			if (*this)
-				std::swap(**this && *other);
+		noexcept(std::is_nothrow_move_constructible<T>::value && details::IS_NOTHROW_SWAPPABLE<T>) {
+		if (*this) {
+			if (other) {
+				using std::swap;
+				swap(**this, *other);
+			}
 			else {
-				this->construct(std::move(*other));
-				other.destruct();
+				other.construct(std::move(**this));
+				this->destruct();
 			}
 		}
-		else {
-			other.construct(std::move(**this));
-			this->destruct();
+		else if (other) {
+			this->construct(std::move(*other));
+			other.destruct();
 		}
 	}
 
@@ -531,7 +998,36 @@ public:
 		return emplaceWithoutReset(ilist, std::forward<Args>(args)...);
 	}
 
+	// Constructs the result of f(args...) in place, see the FromInvoke
+	// constructor. If f throws, the optional is left disengaged.
+	template <typename F, typename... Args>
+	T& emplaceWith(F&& f, Args&&... args) {
+		this->reset();
+		this->constructWith(std::forward<F>(f), std::forward<Args>(args)...);
+		return **this;
+	}
+
 private:
+	// Reading the payload of a disengaged optional is only defined when the
+	// policy keeps it determinate.
+	using BranchlessValueOr = std::integral_constant<bool
+		, details::BRANCHLESS_SELECTABLE<std::remove_cv_t<T>> && details::DETERMINATE_EMPTY_PAYLOAD<Policy>>;
+
+	template <typename U>
+	constexpr T valueOrImpl(std::true_type, U&& defaultValue) const noexcept {
+		return details::select(this->hasValue(), this->storage(), static_cast<T>(std::forward<U>(defaultValue)));
+	}
+
+	template <typename U>
+	constexpr T valueOrImpl(std::false_type, U&& defaultValue) const& {
+		return (*this) ? **this : static_cast<T>(std::forward<U>(defaultValue));
+	}
+
+	template <typename U>
+	constexpr T valueOrImpl(std::false_type, U&& defaultValue) && {
+		return (*this) ? std::move(**this) : static_cast<T>(std::forward<U>(defaultValue));
+	}
+
 	template <typename... Args
 		, std::enable_if_t<std::is_constructible<T, Args&&...>::value, int>...>
 	T& emplaceWithoutReset(Args&&... args) {
@@ -547,6 +1043,11 @@ private:
 	}
 };
 
+template <typename T, typename Policy>
+void swap(Optional<T, Policy>& lhs, Optional<T, Policy>& rhs) noexcept(noexcept(lhs.swap(rhs))) {
+	lhs.swap(rhs);
+}
+
 template <typename T, typename Policy, typename U, typename OtherPolicy>
 constexpr bool operator ==(const Optional<T, Policy>& lhs, const Optional<U, OtherPolicy>& rhs) {
 	return static_cast<bool>(lhs) == static_cast<bool>(rhs)
@@ -555,7 +1056,7 @@ constexpr bool operator ==(const Optional<T, Policy>& lhs, const Optional<U, Oth
 
 template <typename T, typename Policy, typename U, typename OtherPolicy>
 constexpr bool operator !=(const Optional<T, Policy>& lhs, const Optional<U, OtherPolicy>& rhs) {
-	return lhs != rhs;
+	return !(lhs == rhs);
 }
 
 template <typename T, typename Policy, typename U, typename OtherPolicy>
@@ -698,19 +1199,42 @@ constexpr bool operator >=(const U& lhs, const Optional<T, Policy>& rhs) {
 	return !rhs || !(lhs < *rhs);
 }
 
-template <typename T, typename Policy = DefaultOptionalPolicy<T>>
+template <typename T, typename Policy = typename OptionalTraits<std::decay_t<T>>::Policy>
 constexpr Optional<std::decay_t<T>, Policy> makeOptional(T&& value) {
 	return Optional<std::decay_t<T>, Policy>(std::forward<T>(value));
 }
 
-template <typename T, typename Policy = DefaultOptionalPolicy<T>, typename... Args>
+template <typename T, typename Policy = typename OptionalTraits<T>::Policy, typename... Args>
 constexpr Optional<T, Policy> makeOptional(Args&&... args) {
 	return Optional<T, Policy>(inPlace, std::forward<Args>(args)...);
 }
 
-template <typename T, typename U, typename Policy = DefaultOptionalPolicy<T>, typename... Args>
+template <typename T, typename U, typename Policy = typename OptionalTraits<T>::Policy, typename... Args>
 constexpr Optional<T, Policy> makeOptional(std::initializer_list<U> ilist, Args&&... args) {
 	return Optional<T, Policy>(inPlace, ilist, std::forward<Args>(args)...);
 }
 
+// Compile-time report of the layout Optional<T, Policy> ends up with.
+template <typename T, typename Policy = typename OptionalTraits<T>::Policy>
+struct OptionalLayout {
+	using ChosenPolicy = Policy;
+
+	static constexpr std::size_t size() noexcept {
+		return sizeof(Optional<T, Policy>);
+	}
+
+	static constexpr std::size_t alignment() noexcept {
+		return alignof(Optional<T, Policy>);
+	}
+
+	// Bytes spent on top of a bare T to track engagement.
+	static constexpr std::size_t overhead() noexcept {
+		return size() - sizeof(T);
+	}
+
+	static constexpr bool compact() noexcept {
+		return overhead() == 0;
+	}
+};
+
 } // namespace util
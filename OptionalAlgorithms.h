@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "Optional.h"
+
+namespace util {
+
+// Specialize for policies whose disengaged Optional can be produced by zeroing
+// all of its bytes. Range operations then clear whole buffers with memset
+// whenever the Optional is also trivially copyable, so that writing its bytes
+// creates it.
+template <typename Policy>
+struct IsZeroEmptyPolicy : std::false_type {
+};
+
+template <typename T>
+struct IsZeroEmptyPolicy<DefaultOptionalPolicy<T>> : std::true_type {
+};
+
+template <typename T, T SENTINEL>
+struct IsZeroEmptyPolicy<SentinelOptionalPolicy<T, SENTINEL>>
+	: std::integral_constant<bool, SENTINEL == T()> {
+};
+
+template <typename Policy>
+struct IsZeroEmptyPolicy<LikelyEngaged<Policy>> : IsZeroEmptyPolicy<Policy> {
+};
+
+template <typename Policy>
+struct IsZeroEmptyPolicy<LikelyEmpty<Policy>> : IsZeroEmptyPolicy<Policy> {
+};
+
+// Specialize for types whose objects may be moved to another address by
+// copying their bytes and forgetting the source, e.g. most owning handles.
+// Ranges of such optionals are swapped bytewise.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+namespace details {
+
+template <typename T, typename Policy>
+constexpr bool ZERO_FILLABLE_OPTIONAL = IsZeroEmptyPolicy<Policy>::value && TRIVIALLY_COPYABLE_OPTIONAL<T, Policy>;
+
+template <typename T, typename Policy>
+constexpr bool BITWISE_SWAPPABLE_OPTIONAL = IsTriviallyRelocatable<std::remove_cv_t<T>>::value
+	&& std::is_trivially_copyable<Policy>::value;
+
+// Swaps the bytes of two non-overlapping buffers through a fixed-size stack
+// block, which the compiler turns into wide vector loads and stores.
+inline void swapBytes(unsigned char* a, unsigned char* b, std::size_t size) noexcept {
+	constexpr std::size_t BLOCK_SIZE = 256;
+	unsigned char block[BLOCK_SIZE];
+	for (; size >= BLOCK_SIZE; size -= BLOCK_SIZE, a += BLOCK_SIZE, b += BLOCK_SIZE) {
+		std::memcpy(block, a, BLOCK_SIZE);
+		std::memcpy(a, b, BLOCK_SIZE);
+		std::memcpy(b, block, BLOCK_SIZE);
+	}
+	std::memcpy(block, a, size);
+	std::memcpy(a, b, size);
+	std::memcpy(b, block, size);
+}
+
+// Calls f(i) for every engaged element of [first, first + count). Engagement
+// is gathered 64 elements at a time into a mask without branching, so only
+// engaged elements cost a jump.
+template <typename T, typename Policy, typename F>
+void forEachEngaged(const Optional<T, Policy>* first, std::size_t count, F&& f) {
+	for (std::size_t block = 0; block < count; block += 64) {
+		const std::size_t blockSize = count - block < 64 ? count - block : 64;
+		std::uint64_t engaged = 0;
+		for (std::size_t i = 0; i != blockSize; ++i)
+			engaged |= std::uint64_t(static_cast<bool>(first[block + i])) << i;
+		for (; engaged; engaged &= engaged - 1)
+			f(block + countTrailingZeros(engaged));
+	}
+}
+
+template <typename T, typename Policy>
+void fillNullopt(Optional<T, Policy>* first, std::size_t count, std::true_type) noexcept {
+	std::memset(static_cast<void*>(first), 0, count * sizeof(Optional<T, Policy>));
+}
+
+template <typename T, typename Policy>
+void fillNullopt(Optional<T, Policy>* first, std::size_t count, std::false_type) noexcept {
+	for (std::size_t i = 0; i != count; ++i)
+		::new (static_cast<void*>(first + i)) Optional<T, Policy>();
+}
+
+template <typename T, typename Policy>
+void destroyRange(Optional<T, Policy>*, std::size_t, std::true_type) noexcept {
+}
+
+template <typename T, typename Policy>
+void destroyRange(Optional<T, Policy>* first, std::size_t count, std::false_type) noexcept {
+	forEachEngaged(first, count, [first](std::size_t i) { (*first[i]).~T(); });
+}
+
+template <typename T, typename Policy>
+void resetAll(Optional<T, Policy>* first, std::size_t count, std::true_type) noexcept {
+	fillNullopt(first, count, std::integral_constant<bool, ZERO_FILLABLE_OPTIONAL<T, Policy>>{});
+}
+
+template <typename T, typename Policy>
+void resetAll(Optional<T, Policy>* first, std::size_t count, std::false_type) noexcept {
+	forEachEngaged(first, count, [first](std::size_t i) { first[i].reset(); });
+}
+
+template <typename T, typename Policy>
+Optional<T, Policy>* uninitializedCopy(const Optional<T, Policy>* first, std::size_t count
+	, Optional<T, Policy>* dest, std::true_type) noexcept {
+	std::memcpy(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Optional<T, Policy>));
+	return dest + count;
+}
+
+template <typename T, typename Policy>
+Optional<T, Policy>* uninitializedCopy(const Optional<T, Policy>* first, std::size_t count
+	, Optional<T, Policy>* dest, std::false_type) {
+	std::size_t i = 0;
+	try {
+		for (; i != count; ++i)
+			::new (static_cast<void*>(dest + i)) Optional<T, Policy>(first[i]);
+	}
+	catch (...) {
+		destroyRange(dest, i, std::false_type{});
+		throw;
+	}
+	return dest + count;
+}
+
+template <typename T, typename Policy>
+void swapRanges(Optional<T, Policy>* first1, std::size_t count, Optional<T, Policy>* first2, std::true_type) noexcept {
+	swapBytes(reinterpret_cast<unsigned char*>(first1), reinterpret_cast<unsigned char*>(first2)
+		, count * sizeof(Optional<T, Policy>));
+}
+
+template <typename T, typename Policy>
+void swapRanges(Optional<T, Policy>* first1, std::size_t count, Optional<T, Policy>* first2, std::false_type)
+	noexcept(noexcept(first1->swap(*first2))) {
+	for (std::size_t i = 0; i != count; ++i)
+		first1[i].swap(first2[i]);
+}
+
+template <typename T, typename Policy>
+Optional<T, Policy>* moveAssignRange(Optional<T, Policy>* first, std::size_t count
+	, Optional<T, Policy>* dest, std::true_type) noexcept {
+	std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Optional<T, Policy>));
+	return dest + count;
+}
+
+template <typename T, typename Policy>
+Optional<T, Policy>* moveAssignRange(Optional<T, Policy>* first, std::size_t count
+	, Optional<T, Policy>* dest, std::false_type) {
+	for (std::size_t i = 0; i != count; ++i)
+		dest[i] = std::move(first[i]);
+	return dest + count;
+}
+
+} // namespace details
+
+// Ends the lifetime of every element in [first, last). Free for trivially
+// destructible T; otherwise only engaged elements are visited.
+template <typename T, typename Policy>
+void destroyRange(Optional<T, Policy>* first, Optional<T, Policy>* last) noexcept {
+	details::destroyRange(first, static_cast<std::size_t>(last - first)
+		, std::is_trivially_destructible<Optional<T, Policy>>{});
+}
+
+// Disengages every element in [first, last). Trivially destructible payloads
+// are overwritten with the empty state without looking at them.
+template <typename T, typename Policy>
+void resetAll(Optional<T, Policy>* first, Optional<T, Policy>* last) noexcept {
+	details::resetAll(first, static_cast<std::size_t>(last - first)
+		, std::is_trivially_destructible<T>{});
+}
+
+// Constructs disengaged optionals in the raw memory [first, last).
+template <typename T, typename Policy>
+void uninitializedFillNullopt(Optional<T, Policy>* first, Optional<T, Policy>* last) noexcept {
+	details::fillNullopt(first, static_cast<std::size_t>(last - first)
+		, std::integral_constant<bool, details::ZERO_FILLABLE_OPTIONAL<T, Policy>>{});
+}
+
+// Copy-constructs [first, last) into the raw memory starting at dest and
+// returns the end of the copy. If a copy throws, the elements already built
+// are destroyed.
+template <typename T, typename Policy>
+Optional<T, Policy>* uninitializedCopy(const Optional<T, Policy>* first, const Optional<T, Policy>* last
+	, Optional<T, Policy>* dest) {
+	return details::uninitializedCopy(first, static_cast<std::size_t>(last - first), dest
+		, std::integral_constant<bool, details::TRIVIALLY_COPYABLE_OPTIONAL<T, Policy>>{});
+}
+
+// Swaps [first1, last1) with the non-overlapping range starting at first2.
+// Trivially relocatable payloads are swapped as raw bytes in vector-sized
+// blocks instead of element by element.
+template <typename T, typename Policy>
+void swapRanges(Optional<T, Policy>* first1, Optional<T, Policy>* last1, Optional<T, Policy>* first2)
+	noexcept(details::BITWISE_SWAPPABLE_OPTIONAL<T, Policy> || noexcept(first1->swap(*first2))) {
+	details::swapRanges(first1, static_cast<std::size_t>(last1 - first1), first2
+		, std::integral_constant<bool, details::BITWISE_SWAPPABLE_OPTIONAL<T, Policy>>{});
+}
+
+// Move-assigns [first, last) to the range starting at dest, front to back,
+// and returns the end of the destination range. As with std::move, dest must
+// not lie within [first, last). Trivially copyable payloads are moved with a
+// single memmove.
+template <typename T, typename Policy>
+Optional<T, Policy>* moveAssignRange(Optional<T, Policy>* first, Optional<T, Policy>* last
+	, Optional<T, Policy>* dest) {
+	return details::moveAssignRange(first, static_cast<std::size_t>(last - first), dest
+		, std::integral_constant<bool, details::TRIVIALLY_COPYABLE_OPTIONAL<T, Policy>>{});
+}
+
+} // namespace util
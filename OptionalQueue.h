@@ -0,0 +1,340 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "Optional.h"
+
+namespace util {
+
+namespace details {
+
+constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+// Throws std::length_error if no power of two in std::size_t is large enough.
+inline std::size_t roundUpToPowerOfTwo(std::size_t n) {
+	constexpr std::size_t LARGEST = ~(~std::size_t(0) >> 1);
+	if (n > LARGEST)
+		throw std::length_error("util queue capacity too large");
+	std::size_t result = 1;
+	while (result < n)
+		result <<= 1;
+	return result;
+}
+
+} // namespace details
+
+// Bounded wait-free queue for exactly one producer thread and one consumer
+// thread. Each side keeps a cached copy of the other side's index so that the
+// shared cache lines are only touched when the queue looks full or empty.
+template <typename T>
+class SpscQueue {
+public:
+	using ValueType = T;
+
+	// The capacity is rounded up to a power of two. Throws std::length_error if
+	// that power of two does not fit in std::size_t.
+	explicit SpscQueue(std::size_t capacity)
+		: m_mask(details::roundUpToPowerOfTwo(capacity < 1 ? 1 : capacity) - 1)
+		, m_slots(new details::OptionalStorage<T>[m_mask + 1]) {
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator =(const SpscQueue&) = delete;
+
+	~SpscQueue() {
+		const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		for (std::size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i)
+			m_slots[i & m_mask].ref().~T();
+	}
+
+	std::size_t capacity() const noexcept {
+		return m_mask + 1;
+	}
+
+	template <typename... Args>
+	bool tryEmplace(Args&&... args) {
+		const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (freeSlots(tail) == 0)
+			return false;
+		m_slots[tail & m_mask].emplace(std::forward<Args>(args)...);
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPush(const T& value) {
+		return tryEmplace(value);
+	}
+
+	bool tryPush(T&& value) {
+		return tryEmplace(std::move(value));
+	}
+
+	// Pushes elements from [first, last) until the queue is full and publishes
+	// them with a single store. Returns the number of elements pushed.
+	template <typename InputIt>
+	std::size_t tryPushBatch(InputIt first, InputIt last) {
+		const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+		const std::size_t available = freeSlots(tail);
+		std::size_t count = 0;
+		try {
+			for (; count != available && first != last; ++count, ++first)
+				m_slots[(tail + count) & m_mask].emplace(*first);
+		}
+		catch (...) {
+			m_tail.store(tail + count, std::memory_order_release);
+			throw;
+		}
+		m_tail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	Optional<T> tryPop() {
+		const std::size_t head = m_head.load(std::memory_order_relaxed);
+		if (usedSlots(head) == 0)
+			return nullopt;
+		T& item = m_slots[head & m_mask].ref();
+		Optional<T> result(inPlace, std::move(item));
+		item.~T();
+		m_head.store(head + 1, std::memory_order_release);
+		return result;
+	}
+
+	// Moves up to maxCount elements to out and releases their slots with a
+	// single store. Returns the number of elements popped.
+	template <typename OutputIt>
+	std::size_t tryPopBatch(OutputIt out, std::size_t maxCount) {
+		const std::size_t head = m_head.load(std::memory_order_relaxed);
+		const std::size_t available = usedSlots(head);
+		const std::size_t count = available < maxCount ? available : maxCount;
+		std::size_t i = 0;
+		try {
+			for (; i != count; ++i, ++out) {
+				T& item = m_slots[(head + i) & m_mask].ref();
+				*out = std::move(item);
+				item.~T();
+			}
+		}
+		catch (...) {
+			m_head.store(head + i, std::memory_order_release);
+			throw;
+		}
+		m_head.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	// Producer side only.
+	std::size_t freeSlots(std::size_t tail) noexcept {
+		if (tail - m_cachedHead == capacity())
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+		return capacity() - (tail - m_cachedHead);
+	}
+
+	// Consumer side only.
+	std::size_t usedSlots(std::size_t head) noexcept {
+		if (m_cachedTail == head)
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+		return m_cachedTail - head;
+	}
+
+	const std::size_t m_mask;
+	const std::unique_ptr<details::OptionalStorage<T>[]> m_slots;
+
+	alignas(details::CACHE_LINE_SIZE) std::atomic<std::size_t> m_head{0};
+	std::size_t m_cachedTail = 0;
+
+	alignas(details::CACHE_LINE_SIZE) std::atomic<std::size_t> m_tail{0};
+	std::size_t m_cachedHead = 0;
+};
+
+// Bounded lock-free queue for any number of producers and consumers. Every
+// slot carries a sequence number telling which lap of the ring it belongs to,
+// so producers and consumers only contend on their own position counter.
+//
+// A claimed slot has to be filled or drained, so T must be nothrow move
+// constructible; pushes that may throw build their T before claiming a slot.
+template <typename T>
+class MpmcQueue {
+	static_assert(std::is_nothrow_move_constructible<T>::value
+		, "util::MpmcQueue requires a nothrow move constructible type");
+
+public:
+	using ValueType = T;
+
+	// The capacity is rounded up to a power of two. Throws std::length_error if
+	// that power of two does not fit in std::size_t.
+	explicit MpmcQueue(std::size_t capacity)
+		: m_mask(details::roundUpToPowerOfTwo(capacity < 1 ? 1 : capacity) - 1)
+		, m_cells(new Cell[m_mask + 1]) {
+		for (std::size_t i = 0; i <= m_mask; ++i)
+			m_cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	MpmcQueue(const MpmcQueue&) = delete;
+	MpmcQueue& operator =(const MpmcQueue&) = delete;
+
+	~MpmcQueue() {
+		const std::size_t tail = m_enqueuePos.load(std::memory_order_relaxed);
+		for (std::size_t i = m_dequeuePos.load(std::memory_order_relaxed); i != tail; ++i)
+			m_cells[i & m_mask].storage.ref().~T();
+	}
+
+	std::size_t capacity() const noexcept {
+		return m_mask + 1;
+	}
+
+	template <typename... Args
+		, std::enable_if_t<std::is_nothrow_constructible<T, Args&&...>::value, int> = 0>
+	bool tryEmplace(Args&&... args) noexcept {
+		const std::size_t pos = claim(m_enqueuePos, 0);
+		if (pos == NO_POSITION)
+			return false;
+		Cell& cell = m_cells[pos & m_mask];
+		cell.storage.emplace(std::forward<Args>(args)...);
+		cell.sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename... Args
+		, std::enable_if_t<!std::is_nothrow_constructible<T, Args&&...>::value, int> = 0>
+	bool tryEmplace(Args&&... args) {
+		return tryEmplace(T(std::forward<Args>(args)...));
+	}
+
+	bool tryPush(const T& value) {
+		return tryEmplace(value);
+	}
+
+	bool tryPush(T&& value) noexcept {
+		return tryEmplace(std::move(value));
+	}
+
+	// Claims as many consecutive slots as are free, up to the length of the
+	// range, with a single compare-and-swap. Returns the number of elements
+	// pushed. Elements are moved out of the range when it yields rvalues.
+	template <typename ForwardIt>
+	std::size_t tryPushBatch(ForwardIt first, ForwardIt last) {
+		static_assert(std::is_nothrow_constructible<T, decltype(*first)>::value
+			, "Batch elements must be nothrow constructible into T");
+		std::size_t count = 0;
+		const std::size_t pos = claimBatch(m_enqueuePos, 0
+			, static_cast<std::size_t>(std::distance(first, last)), count);
+		for (std::size_t i = 0; i != count; ++i, ++first) {
+			Cell& cell = m_cells[(pos + i) & m_mask];
+			cell.storage.emplace(*first);
+			cell.sequence.store(pos + i + 1, std::memory_order_release);
+		}
+		return count;
+	}
+
+	Optional<T> tryPop() noexcept {
+		const std::size_t pos = claim(m_dequeuePos, 1);
+		if (pos == NO_POSITION)
+			return nullopt;
+		Optional<T> result(inPlace, std::move(m_cells[pos & m_mask].storage.ref()));
+		release(pos);
+		return result;
+	}
+
+	// Claims up to maxCount consecutive filled slots with a single
+	// compare-and-swap and moves their elements to out. Returns the number of
+	// elements popped.
+	//
+	// Claimed slots cannot be handed back, so if writing to out throws, the
+	// element being written and every element claimed after it are destroyed
+	// and their slots released before the exception propagates.
+	template <typename OutputIt>
+	std::size_t tryPopBatch(OutputIt out, std::size_t maxCount) {
+		std::size_t count = 0;
+		const std::size_t pos = claimBatch(m_dequeuePos, 1, maxCount, count);
+		std::size_t i = 0;
+		try {
+			for (; i != count; ++i, ++out) {
+				T& item = m_cells[(pos + i) & m_mask].storage.ref();
+				*out = std::move(item);
+				release(pos + i);
+			}
+		}
+		catch (...) {
+			for (; i != count; ++i)
+				release(pos + i);
+			throw;
+		}
+		return count;
+	}
+
+private:
+	struct Cell {
+		std::atomic<std::size_t> sequence;
+		details::OptionalStorage<T> storage;
+	};
+
+	static constexpr std::size_t NO_POSITION = ~std::size_t(0);
+
+	// A slot at position pos is ready for the side with the given lag when its
+	// sequence equals pos + lag: 0 for producers, 1 for consumers.
+	std::size_t claim(std::atomic<std::size_t>& position, std::size_t lag) noexcept {
+		std::size_t pos = position.load(std::memory_order_relaxed);
+		for (;;) {
+			const std::size_t sequence = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + lag);
+			if (diff == 0) {
+				if (position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					return pos;
+			}
+			else if (diff < 0)
+				return NO_POSITION;
+			else
+				pos = position.load(std::memory_order_relaxed);
+		}
+	}
+
+	// Destroys the element at a claimed position and hands its slot to the
+	// producers of the next lap.
+	void release(std::size_t pos) noexcept {
+		Cell& cell = m_cells[pos & m_mask];
+		cell.storage.ref().~T();
+		cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+	}
+
+	// Slots can only be handed to another thread through position, so every
+	// slot found ready before a successful exchange is still ready after it.
+	std::size_t claimBatch(std::atomic<std::size_t>& position, std::size_t lag
+		, std::size_t maxCount, std::size_t& count) noexcept {
+		const std::size_t limit = maxCount < capacity() ? maxCount : capacity();
+		std::size_t pos = position.load(std::memory_order_relaxed);
+		for (;;) {
+			count = 0;
+			if (limit == 0)
+				return pos;
+			const std::size_t sequence = m_cells[pos & m_mask].sequence.load(std::memory_order_acquire);
+			const auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(pos + lag);
+			if (diff < 0)
+				return pos;
+			if (diff > 0) {
+				pos = position.load(std::memory_order_relaxed);
+				continue;
+			}
+			count = 1;
+			while (count != limit
+				&& m_cells[(pos + count) & m_mask].sequence.load(std::memory_order_acquire) == pos + count + lag)
+				++count;
+			if (position.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+				return pos;
+		}
+	}
+
+	const std::size_t m_mask;
+	const std::unique_ptr<Cell[]> m_cells;
+
+	alignas(details::CACHE_LINE_SIZE) std::atomic<std::size_t> m_enqueuePos{0};
+	alignas(details::CACHE_LINE_SIZE) std::atomic<std::size_t> m_dequeuePos{0};
+};
+
+} // namespace util
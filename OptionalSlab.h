@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "Optional.h"
+
+namespace util {
+
+// Identifies an element of an OptionalSlab. The generation makes a handle go
+// stale once its element is erased, even if the slot is reused afterwards.
+struct SlabHandle {
+	std::uint32_t index;
+	std::uint32_t generation;
+};
+
+constexpr bool operator ==(SlabHandle lhs, SlabHandle rhs) noexcept {
+	return lhs.index == rhs.index && lhs.generation == rhs.generation;
+}
+
+constexpr bool operator !=(SlabHandle lhs, SlabHandle rhs) noexcept {
+	return !(lhs == rhs);
+}
+
+// Fixed-capacity pool with O(1) insertion and erasure. A disengaged slot
+// reuses the bytes of its OptionalStorage to hold the index of the next free
+// slot, and a side bitmap of engaged slots drives iteration so that it only
+// visits live elements.
+template <typename T>
+class OptionalSlab {
+public:
+	using ValueType = T;
+	using Handle = SlabHandle;
+
+	// Throws std::length_error if capacity does not fit the 32-bit indices of
+	// a handle.
+	explicit OptionalSlab(std::size_t capacity)
+		: m_capacity(checkedCapacity(capacity))
+		, m_slots(new Slot[capacity])
+		, m_engaged(new std::uint64_t[wordCount()]()) {
+		for (std::uint32_t i = 0; i != m_capacity; ++i) {
+			m_slots[i].nextFree = i + 1 == m_capacity ? NO_INDEX : i + 1;
+			m_slots[i].generation = 0;
+		}
+		m_freeHead = m_capacity == 0 ? NO_INDEX : 0;
+	}
+
+	OptionalSlab(const OptionalSlab&) = delete;
+	OptionalSlab& operator =(const OptionalSlab&) = delete;
+
+	~OptionalSlab() {
+		forEachIndex([this](std::uint32_t index) { m_slots[index].value.ref().~T(); });
+	}
+
+	std::size_t capacity() const noexcept {
+		return m_capacity;
+	}
+
+	std::size_t size() const noexcept {
+		return m_size;
+	}
+
+	bool empty() const noexcept {
+		return m_size == 0;
+	}
+
+	// Returns nullopt if the slab is full.
+	template <typename... Args>
+	Optional<Handle> tryEmplace(Args&&... args) {
+		if (m_freeHead == NO_INDEX)
+			return nullopt;
+		const std::uint32_t index = m_freeHead;
+		Slot& slot = m_slots[index];
+		const std::uint32_t next = slot.nextFree;
+		try {
+			slot.value.emplace(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			slot.nextFree = next;
+			throw;
+		}
+		m_freeHead = next;
+		m_engaged[index / 64] |= bit(index);
+		++m_size;
+		return Handle{index, slot.generation};
+	}
+
+	Optional<Handle> tryInsert(const T& value) {
+		return tryEmplace(value);
+	}
+
+	Optional<Handle> tryInsert(T&& value) {
+		return tryEmplace(std::move(value));
+	}
+
+	// Returns false if the handle is stale.
+	bool erase(Handle handle) noexcept {
+		if (!contains(handle))
+			return false;
+		Slot& slot = m_slots[handle.index];
+		slot.value.ref().~T();
+		slot.nextFree = m_freeHead;
+		++slot.generation;
+		m_freeHead = handle.index;
+		m_engaged[handle.index / 64] &= ~bit(handle.index);
+		--m_size;
+		return true;
+	}
+
+	bool contains(Handle handle) const noexcept {
+		return handle.index < m_capacity
+			&& (m_engaged[handle.index / 64] & bit(handle.index))
+			&& m_slots[handle.index].generation == handle.generation;
+	}
+
+	// Returns nullptr if the handle is stale.
+	T* find(Handle handle) noexcept {
+		return contains(handle) ? m_slots[handle.index].value.data() : nullptr;
+	}
+
+	const T* find(Handle handle) const noexcept {
+		return contains(handle) ? m_slots[handle.index].value.data() : nullptr;
+	}
+
+	// Calls f(handle, element) for every live element in index order.
+	template <typename F>
+	void forEach(F&& f) {
+		forEachIndex([this, &f](std::uint32_t index) {
+			f(Handle{index, m_slots[index].generation}, m_slots[index].value.ref());
+		});
+	}
+
+	template <typename F>
+	void forEach(F&& f) const {
+		forEachIndex([this, &f](std::uint32_t index) {
+			const Slot& slot = m_slots[index];
+			f(Handle{index, slot.generation}, slot.value.ref());
+		});
+	}
+
+	// Invalidates every outstanding handle.
+	void clear() noexcept {
+		forEachIndex([this](std::uint32_t index) {
+			Slot& slot = m_slots[index];
+			slot.value.ref().~T();
+			slot.nextFree = m_freeHead;
+			++slot.generation;
+			m_freeHead = index;
+		});
+		for (std::size_t i = 0; i != wordCount(); ++i)
+			m_engaged[i] = 0;
+		m_size = 0;
+	}
+
+private:
+	static constexpr std::uint32_t NO_INDEX = ~std::uint32_t(0);
+
+	struct Slot {
+		union {
+			details::OptionalStorage<T> value;
+			std::uint32_t nextFree;
+		};
+		std::uint32_t generation;
+	};
+
+	static std::uint32_t checkedCapacity(std::size_t capacity) {
+		if (capacity >= NO_INDEX)
+			throw std::length_error("util::OptionalSlab capacity too large");
+		return static_cast<std::uint32_t>(capacity);
+	}
+
+	static std::uint64_t bit(std::uint32_t index) noexcept {
+		return std::uint64_t(1) << (index % 64);
+	}
+
+	std::size_t wordCount() const noexcept {
+		return (std::size_t(m_capacity) + 63) / 64;
+	}
+
+	template <typename F>
+	void forEachIndex(F&& f) const {
+		for (std::size_t i = 0; i != wordCount(); ++i) {
+			for (std::uint64_t word = m_engaged[i]; word; word &= word - 1)
+				f(static_cast<std::uint32_t>(i * 64 + details::countTrailingZeros(word)));
+		}
+	}
+
+	const std::uint32_t m_capacity;
+	const std::unique_ptr<Slot[]> m_slots;
+	const std::unique_ptr<std::uint64_t[]> m_engaged;
+	std::uint32_t m_freeHead;
+	std::size_t m_size = 0;
+};
+
+} // namespace util
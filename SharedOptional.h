@@ -0,0 +1,325 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Optional.h"
+
+namespace util {
+
+// Reference count for SharedOptionals that never cross threads.
+class NonAtomicRefCount {
+public:
+	void increment() noexcept {
+		++m_count;
+	}
+
+	// Returns true if the last reference was dropped.
+	bool decrement() noexcept {
+		return --m_count == 0;
+	}
+
+	std::size_t count() const noexcept {
+		return m_count;
+	}
+
+private:
+	std::size_t m_count = 1;
+};
+
+class AtomicRefCount {
+public:
+	void increment() noexcept {
+		m_count.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Returns true if the last reference was dropped.
+	bool decrement() noexcept {
+		return m_count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+	}
+
+	std::size_t count() const noexcept {
+		return m_count.load(std::memory_order_acquire);
+	}
+
+private:
+	std::atomic<std::size_t> m_count{1};
+};
+
+// Optional whose copies share a single heap allocated payload. Const access
+// never copies; non-const access and emplace clone the payload first if any
+// other SharedOptional refers to it, so a copy behaves like a deep copy while
+// costing a reference count increment. A disengaged SharedOptional holds no
+// allocation and the whole object is a single pointer.
+//
+// Non-const access hands out a reference that may be written through later,
+// so it also marks the payload as unshareable: copies made from then on clone
+// it for as long as this SharedOptional keeps the same allocation. A payload
+// that nothing else refers to is reused by value assignment and emplace, so
+// only reset(), or assigning another SharedOptional, makes it shareable again.
+template <typename T, typename RefCount = AtomicRefCount>
+class SharedOptional {
+	static_assert(!std::is_same<std::remove_cv_t<T>, Nullopt>::value
+		&& !std::is_same<std::remove_cv_t<T>, InPlace>::value
+		&& !std::is_reference<T>::value
+		&& !std::is_const<T>::value, "Invalid instantiation of util::SharedOptional");
+
+public:
+	using ValueType = T;
+
+	SharedOptional() noexcept = default;
+
+	SharedOptional(Nullopt) noexcept {
+	}
+
+	template <typename... Args>
+	explicit SharedOptional(InPlace, Args&&... args)
+		: m_block(new Block(std::forward<Args>(args)...)) {
+	}
+
+	template <typename U = T
+		, std::enable_if_t<!std::is_same<SharedOptional, std::decay_t<U>>::value
+			&& !std::is_same<Nullopt, std::decay_t<U>>::value
+			&& std::is_constructible<T, U&&>::value, bool> = true>
+	SharedOptional(U&& value)
+		: SharedOptional(inPlace, std::forward<U>(value)) {
+	}
+
+	template <typename Policy>
+	explicit SharedOptional(const Optional<T, Policy>& other) {
+		if (other)
+			m_block = new Block(*other);
+	}
+
+	SharedOptional(const SharedOptional& other)
+		: m_block(other.share()) {
+	}
+
+	SharedOptional(SharedOptional&& other) noexcept
+		: m_block(other.m_block) {
+		other.m_block = nullptr;
+	}
+
+	~SharedOptional() {
+		release();
+	}
+
+	SharedOptional& operator =(const SharedOptional& other) {
+		SharedOptional(other).swap(*this);
+		return *this;
+	}
+
+	SharedOptional& operator =(SharedOptional&& other) noexcept {
+		SharedOptional(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	SharedOptional& operator =(Nullopt) noexcept {
+		reset();
+		return *this;
+	}
+
+	template <typename U = T
+		, typename = std::enable_if_t<!std::is_same<SharedOptional, std::decay_t<U>>::value
+			&& !std::is_same<Nullopt, std::decay_t<U>>::value
+			&& std::is_constructible<T, U&&>::value>>
+	SharedOptional& operator =(U&& value) {
+		if (m_block && m_block->count.count() == 1)
+			assign(std::is_assignable<T&, U&&>{}, std::forward<U>(value));
+		else
+			replace(std::forward<U>(value));
+		return *this;
+	}
+
+	bool hasValue() const noexcept {
+		return m_block != nullptr;
+	}
+
+	explicit operator bool() const noexcept {
+		return hasValue();
+	}
+
+	const T& operator *() const {
+		return m_block->value;
+	}
+
+	// Clones the payload if it is shared.
+	T& operator *() {
+		return mutableValue();
+	}
+
+	const T* operator ->() const {
+		return &m_block->value;
+	}
+
+	T* operator ->() {
+		return &mutableValue();
+	}
+
+	const T& value() const {
+		if (!*this)
+			details::throwBadOptionalAccess();
+		return **this;
+	}
+
+	T& value() {
+		if (!*this)
+			details::throwBadOptionalAccess();
+		return **this;
+	}
+
+	template <typename U>
+	T valueOr(U&& defaultValue) const {
+		static_assert(std::is_copy_constructible<T>::value && std::is_convertible<U&&, T>::value
+			, "Cannot return value");
+		return (*this) ? **this : static_cast<T>(std::forward<U>(defaultValue));
+	}
+
+	// Number of SharedOptionals referring to the payload, or 0 if disengaged.
+	std::size_t useCount() const noexcept {
+		return m_block ? m_block->count.count() : 0;
+	}
+
+	bool unique() const noexcept {
+		return useCount() == 1;
+	}
+
+	void reset() noexcept {
+		release();
+		m_block = nullptr;
+	}
+
+	void swap(SharedOptional& other) noexcept {
+		std::swap(m_block, other.m_block);
+	}
+
+	// Never writes through to a payload that other SharedOptionals can see. If
+	// the payload is not shared it is rebuilt in place, and if constructing the
+	// new payload throws, this SharedOptional is left disengaged.
+	template <typename... Args>
+	T& emplace(Args&&... args) {
+		replace(std::forward<Args>(args)...);
+		m_block->shareable = false;
+		return m_block->value;
+	}
+
+private:
+	// The value is a union member so that a unique block can be rebuilt in
+	// place; whoever frees a block destroys its value first.
+	struct Block {
+		template <typename... Args>
+		explicit Block(Args&&... args)
+			: value(std::forward<Args>(args)...) {
+		}
+
+		~Block() {
+		}
+
+		RefCount count;
+		// Only ever cleared while the block is unique, and an unshareable block
+		// is never shared again, so it needs no synchronization.
+		bool shareable = true;
+		union {
+			T value;
+		};
+	};
+
+	T& mutableValue() {
+		if (m_block->count.count() != 1)
+			replace(static_cast<const T&>(m_block->value));
+		m_block->shareable = false;
+		return m_block->value;
+	}
+
+	Block* share() const {
+		if (!m_block)
+			return nullptr;
+		if (!m_block->shareable)
+			return new Block(static_cast<const T&>(m_block->value));
+		m_block->count.increment();
+		return m_block;
+	}
+
+	// Allocates only if the payload is shared or there is none.
+	template <typename... Args>
+	void replace(Args&&... args) {
+		if (m_block && m_block->count.count() == 1) {
+			m_block->value.~T();
+			try {
+				::new (static_cast<void*>(&m_block->value)) T(std::forward<Args>(args)...);
+			}
+			catch (...) {
+				delete m_block;
+				m_block = nullptr;
+				throw;
+			}
+			return;
+		}
+		Block* block = new Block(std::forward<Args>(args)...);
+		release();
+		m_block = block;
+	}
+
+	template <typename U>
+	void assign(std::true_type, U&& value) {
+		m_block->value = std::forward<U>(value);
+	}
+
+	template <typename U>
+	void assign(std::false_type, U&& value) {
+		replace(std::forward<U>(value));
+	}
+
+	void release() noexcept {
+		if (m_block && m_block->count.decrement()) {
+			m_block->value.~T();
+			delete m_block;
+		}
+	}
+
+	Block* m_block = nullptr;
+};
+
+template <typename T>
+using LocalSharedOptional = SharedOptional<T, NonAtomicRefCount>;
+
+template <typename T, typename RefCount>
+void swap(SharedOptional<T, RefCount>& lhs, SharedOptional<T, RefCount>& rhs) noexcept {
+	lhs.swap(rhs);
+}
+
+template <typename T, typename RefCount, typename U, typename OtherRefCount>
+bool operator ==(const SharedOptional<T, RefCount>& lhs, const SharedOptional<U, OtherRefCount>& rhs) {
+	return static_cast<bool>(lhs) == static_cast<bool>(rhs)
+		&& (!lhs || *lhs == *rhs);
+}
+
+template <typename T, typename RefCount, typename U, typename OtherRefCount>
+bool operator !=(const SharedOptional<T, RefCount>& lhs, const SharedOptional<U, OtherRefCount>& rhs) {
+	return !(lhs == rhs);
+}
+
+template <typename T, typename RefCount>
+bool operator ==(const SharedOptional<T, RefCount>& lhs, Nullopt) noexcept {
+	return !lhs;
+}
+
+template <typename T, typename RefCount>
+bool operator ==(Nullopt, const SharedOptional<T, RefCount>& rhs) noexcept {
+	return !rhs;
+}
+
+template <typename T, typename RefCount>
+bool operator !=(const SharedOptional<T, RefCount>& lhs, Nullopt) noexcept {
+	return static_cast<bool>(lhs);
+}
+
+template <typename T, typename RefCount>
+bool operator !=(Nullopt, const SharedOptional<T, RefCount>& rhs) noexcept {
+	return static_cast<bool>(rhs);
+}
+
+} // namespace util
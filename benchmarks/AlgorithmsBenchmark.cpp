@@ -0,0 +1,127 @@
+// Range operations of OptionalAlgorithms.h against per-element loops.
+//
+//   AlgorithmsBenchmark [elements]
+//
+// Every case runs five times on freshly filled buffers and reports the fastest
+// run, since filling dominates the cost and is not timed.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "OptionalAlgorithms.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int RUNS = 5;
+
+template <typename Prepare, typename Work>
+void measure(const char* name, Prepare&& prepare, Work&& work) {
+	double best = 1e30;
+	for (int run = 0; run != RUNS; ++run) {
+		prepare();
+		const Clock::time_point start = Clock::now();
+		work();
+		best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+	}
+	std::printf("  %-40s %8.2f ms\n", name, best);
+}
+
+// Engages every engagedEvery-th element.
+template <typename O, typename Make>
+void fill(std::vector<O>& values, std::size_t engagedEvery, Make make) {
+	for (std::size_t i = 0; i != values.size(); ++i) {
+		if (i % engagedEvery == 0)
+			values[i] = make(i);
+		else
+			values[i].reset();
+	}
+}
+
+template <typename O, typename Make>
+void benchmarkClear(const char* type, std::size_t count, std::size_t engagedEvery, Make make) {
+	std::vector<O> values(count);
+	const auto prepare = [&] { fill(values, engagedEvery, make); };
+	std::printf("clear %zu x %s, 1 in %zu engaged\n", count, type, engagedEvery);
+	measure("reset() per element", prepare, [&] {
+		for (O& value : values)
+			value.reset();
+	});
+	measure("resetAll", prepare, [&] { util::resetAll(values.data(), values.data() + values.size()); });
+}
+
+template <typename O, typename Make>
+void benchmarkSwap(const char* type, std::size_t count, Make make) {
+	std::vector<O> a(count);
+	std::vector<O> b(count);
+	const auto prepare = [&] {
+		fill(a, 2, make);
+		fill(b, 3, make);
+	};
+	std::printf("swap, rotate and shuffle %zu x %s\n", count, type);
+	measure("swap() per element", prepare, [&] {
+		for (std::size_t i = 0; i != count; ++i)
+			a[i].swap(b[i]);
+	});
+	measure("swapRanges", prepare, [&] { util::swapRanges(a.data(), a.data() + count, b.data()); });
+
+	// Rotating by half exchanges the two halves.
+	const std::size_t half = count / 2;
+	measure("std::rotate by half", prepare, [&] { std::rotate(a.begin(), a.begin() + half, a.begin() + 2 * half); });
+	measure("swapRanges of the halves", prepare, [&] {
+		util::swapRanges(a.data(), a.data() + half, a.data() + half);
+	});
+
+	// Shifting left by one, the building block of rotating by a small step.
+	measure("move-assign loop shift by 1", prepare, [&] {
+		for (std::size_t i = 1; i != count; ++i)
+			a[i - 1] = std::move(a[i]);
+	});
+	measure("moveAssignRange shift by 1", prepare, [&] {
+		util::moveAssignRange(a.data() + 1, a.data() + count, a.data());
+	});
+
+	std::mt19937_64 random(42);
+	measure("std::shuffle (Optional::swap)", prepare, [&] { std::shuffle(a.begin(), a.end(), random); });
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::size_t count = 10000000;
+	if (argc > 2 || (argc == 2 && std::atoll(argv[1]) <= 0)) {
+		std::printf("usage: %s [elements]\n", argv[0]);
+		return argc == 2 && std::strcmp(argv[1], "--help") == 0 ? 0 : 1;
+	}
+	if (argc == 2)
+		count = static_cast<std::size_t>(std::atoll(argv[1]));
+
+	const auto makeInt = [](std::size_t i) { return static_cast<int>(i); };
+	const auto makeString = [](std::size_t i) { return std::string(32, static_cast<char>('a' + i % 26)); };
+	benchmarkClear<util::Optional<int>>("Optional<int>", count, 2, makeInt);
+	benchmarkClear<util::Optional<int, util::SentinelOptionalPolicy<int, -1>>>("sentinel Optional<int>", count, 2
+		, makeInt);
+	benchmarkClear<util::Optional<std::string>>("Optional<std::string>", count / 10, 10, makeString);
+
+	std::vector<util::Optional<int>> raw(count);
+	std::printf("construct %zu x Optional<int> disengaged\n", count);
+	measure("placement new per element", [] {}, [&] {
+		for (util::Optional<int>& value : raw)
+			::new (static_cast<void*>(&value)) util::Optional<int>();
+	});
+	measure("uninitializedFillNullopt", [] {}, [&] {
+		util::uninitializedFillNullopt(raw.data(), raw.data() + raw.size());
+	});
+
+	benchmarkSwap<util::Optional<int>>("Optional<int>", count, makeInt);
+	benchmarkSwap<util::Optional<std::string>>("Optional<std::string>", count / 10, makeString);
+	return 0;
+}
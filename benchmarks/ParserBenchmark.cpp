@@ -0,0 +1,104 @@
+// Throughput of DelimitedParser on generated input.
+//
+//   ParserBenchmark [megabytes]
+//
+// Each profile generates 64 MB of records once and feeds it repeatedly in
+// 1 MB chunks, which split records at arbitrary points, until the requested
+// amount has been parsed (1024 MB by default). Columns are drained after every
+// chunk, as a streaming consumer would.
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "DelimitedParser.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Parser = util::DelimitedParser<std::int64_t, double, std::int64_t, double>;
+
+constexpr std::size_t INPUT_SIZE = std::size_t(64) << 20;
+constexpr std::size_t CHUNK_SIZE = std::size_t(1) << 20;
+
+enum class Doubles {
+	SHORT,      // e.g. 1234.56
+	ROUND_TRIP, // %.17g output, e.g. 0.30000000000000004
+};
+
+// One in ten fields is left empty.
+std::string generate(Doubles doubles) {
+	std::mt19937_64 random(42);
+	std::uniform_int_distribution<std::int64_t> integers(-1000000000, 1000000000);
+	std::uniform_real_distribution<double> reals(-1e6, 1e6);
+	std::uniform_int_distribution<int> empty(0, 9);
+	std::string text;
+	text.reserve(INPUT_SIZE + 256);
+	char field[64];
+	while (text.size() < INPUT_SIZE) {
+		for (int column = 0; column != 4; ++column) {
+			if (column != 0)
+				text += ',';
+			if (empty(random) == 0)
+				continue;
+			if (column % 2 == 0)
+				std::snprintf(field, sizeof(field), "%" PRId64, integers(random));
+			else if (doubles == Doubles::SHORT)
+				std::snprintf(field, sizeof(field), "%.2f", reals(random));
+			else
+				std::snprintf(field, sizeof(field), "%.17g", reals(random));
+			text += field;
+		}
+		text += '\n';
+	}
+	return text;
+}
+
+void run(const char* name, Doubles doubles, std::uint64_t totalBytes) {
+	const std::string input = generate(doubles);
+	Parser parser;
+	parser.reserve(CHUNK_SIZE / 8);
+	std::uint64_t parsed = 0;
+	std::uint64_t rows = 0;
+	std::int64_t checksum = 0;
+	const Clock::time_point start = Clock::now();
+	while (parsed < totalBytes) {
+		for (std::size_t offset = 0; offset < input.size(); offset += CHUNK_SIZE) {
+			const std::size_t size = std::min(CHUNK_SIZE, input.size() - offset);
+			parser.feed(input.data() + offset, size);
+			rows += parser.rows();
+			if (parser.rows() != 0)
+				checksum += parser.column<0>()[0].valueOr(0);
+			parser.clearColumns();
+			parsed += size;
+		}
+	}
+	parser.finish();
+	rows += parser.rows();
+	const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	std::printf("  %-20s %8.1f MB/s %8.2f Mrows/s  (checksum %" PRId64 ")\n", name
+		, double(parsed) / seconds / 1e6, double(rows) / seconds / 1e6, checksum);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::uint64_t megabytes = 1024;
+	if (argc > 2 || (argc == 2 && std::atoll(argv[1]) <= 0)) {
+		std::printf("usage: %s [megabytes]\n", argv[0]);
+		return argc == 2 && std::strcmp(argv[1], "--help") == 0 ? 0 : 1;
+	}
+	if (argc == 2)
+		megabytes = static_cast<std::uint64_t>(std::atoll(argv[1]));
+
+	std::printf("%" PRIu64 " MB per profile, columns int64,double,int64,double, 10%% empty fields\n", megabytes);
+	run("short decimals", Doubles::SHORT, megabytes << 20);
+	run("round-trip doubles", Doubles::ROUND_TRIP, megabytes << 20);
+	return 0;
+}
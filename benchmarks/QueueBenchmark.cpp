@@ -0,0 +1,246 @@
+// Throughput and round-trip latency of SpscQueue and MpmcQueue.
+//
+//   QueueBenchmark [items] [producer-cpu:consumer-cpu ...]
+//
+// Every listed core pair runs the single producer, single consumer cases with
+// both threads pinned; without pairs the threads are left to the scheduler.
+// The MPMC case with several producers and consumers is never pinned.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "OptionalQueue.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int NO_CPU = -1;
+constexpr std::size_t CAPACITY = 1024;
+constexpr std::size_t BATCH_SIZE = 32;
+
+void pinTo(int cpu) {
+#if defined(__linux__)
+	if (cpu == NO_CPU)
+		return;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+		std::fprintf(stderr, "warning: cannot pin to cpu %d\n", cpu);
+#else
+	(void)cpu;
+#endif
+}
+
+double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* name, std::uint64_t items, double seconds) {
+	std::printf("  %-28s %8.2f Mitems/s\n", name, double(items) / seconds / 1e6);
+}
+
+template <typename Queue>
+void pushOne(Queue& queue, std::uint64_t value) {
+	while (!queue.tryPush(value))
+		std::this_thread::yield();
+}
+
+template <typename Queue>
+std::uint64_t popOne(Queue& queue) {
+	for (;;) {
+		const util::Optional<std::uint64_t> item = queue.tryPop();
+		if (item)
+			return *item;
+		std::this_thread::yield();
+	}
+}
+
+// One producer and one consumer moving items one at a time, or in batches of
+// BATCH_SIZE when batch is set. Both sides run on their own threads so that
+// pinning never sticks to the main thread.
+template <typename Queue>
+void runPair(const char* name, std::uint64_t items, int producerCpu, int consumerCpu, bool batch) {
+	Queue queue(CAPACITY);
+	std::uint64_t sum = 0;
+	const Clock::time_point start = Clock::now();
+	std::thread consumer([&] {
+		pinTo(consumerCpu);
+		std::uint64_t buffer[BATCH_SIZE];
+		for (std::uint64_t received = 0; received != items;) {
+			if (batch) {
+				const std::size_t count = queue.tryPopBatch(buffer, BATCH_SIZE);
+				for (std::size_t i = 0; i != count; ++i)
+					sum += buffer[i];
+				received += count;
+				if (count == 0)
+					std::this_thread::yield();
+			}
+			else {
+				sum += popOne(queue);
+				++received;
+			}
+		}
+	});
+	std::thread producer([&] {
+		pinTo(producerCpu);
+		std::uint64_t buffer[BATCH_SIZE];
+		for (std::uint64_t sent = 0; sent != items;) {
+			if (!batch) {
+				pushOne(queue, sent++);
+				continue;
+			}
+			const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(BATCH_SIZE, items - sent));
+			for (std::size_t i = 0; i != count; ++i)
+				buffer[i] = sent + i;
+			for (std::size_t pushed = 0; pushed != count;) {
+				const std::size_t n = queue.tryPushBatch(buffer + pushed, buffer + count);
+				if (n == 0)
+					std::this_thread::yield();
+				pushed += n;
+			}
+			sent += count;
+		}
+	});
+	producer.join();
+	consumer.join();
+	const double seconds = secondsSince(start);
+	if (sum != items * (items - 1) / 2)
+		std::fprintf(stderr, "error: %s lost items\n", name);
+	report(name, items, seconds);
+}
+
+// Several producers and consumers sharing one MpmcQueue.
+void runMpmc(std::uint64_t items, unsigned producers, unsigned consumers) {
+	util::MpmcQueue<std::uint64_t> queue(CAPACITY);
+	const std::uint64_t perProducer = items / producers;
+	const std::uint64_t total = perProducer * producers;
+	std::atomic<std::uint64_t> received{0};
+	std::atomic<std::uint64_t> sum{0};
+	std::vector<std::thread> threads;
+
+	const Clock::time_point start = Clock::now();
+	for (unsigned p = 0; p != producers; ++p) {
+		threads.emplace_back([&, p] {
+			for (std::uint64_t i = 0; i != perProducer; ++i)
+				pushOne(queue, p * perProducer + i);
+		});
+	}
+	for (unsigned c = 0; c != consumers; ++c) {
+		threads.emplace_back([&] {
+			std::uint64_t buffer[BATCH_SIZE];
+			std::uint64_t localSum = 0;
+			while (received.load(std::memory_order_relaxed) != total) {
+				const std::size_t count = queue.tryPopBatch(buffer, BATCH_SIZE);
+				if (count == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				for (std::size_t i = 0; i != count; ++i)
+					localSum += buffer[i];
+				received += count;
+			}
+			sum += localSum;
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	const double seconds = secondsSince(start);
+	if (sum != total * (total - 1) / 2)
+		std::fprintf(stderr, "error: mpmc lost items\n");
+	const std::string name = "mpmc " + std::to_string(producers) + "p/" + std::to_string(consumers) + "c batch";
+	report(name.c_str(), total, seconds);
+}
+
+// Bounces one item between two queues and reports percentiles of the round
+// trip, which is free of the queueing delay a saturated queue would add.
+template <typename Queue>
+void runPingPong(const char* name, std::uint64_t samples, int producerCpu, int consumerCpu) {
+	Queue ping(CAPACITY);
+	Queue pong(CAPACITY);
+	std::thread echo([&] {
+		pinTo(consumerCpu);
+		for (std::uint64_t i = 0; i != samples; ++i)
+			pushOne(pong, popOne(ping));
+	});
+	std::vector<std::uint64_t> roundTrips(samples);
+	std::thread producer([&] {
+		pinTo(producerCpu);
+		for (std::uint64_t i = 0; i != samples; ++i) {
+			const Clock::time_point sent = Clock::now();
+			pushOne(ping, i);
+			popOne(pong);
+			roundTrips[i] = static_cast<std::uint64_t>(
+				std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count());
+		}
+	});
+	producer.join();
+	echo.join();
+	std::sort(roundTrips.begin(), roundTrips.end());
+	const auto percentile = [&roundTrips](double p) {
+		return roundTrips[static_cast<std::size_t>(p * double(roundTrips.size() - 1))];
+	};
+	std::printf("  %-28s p50 %6llu ns  p99 %6llu ns  p99.9 %7llu ns  max %8llu ns\n", name
+		, static_cast<unsigned long long>(percentile(0.5)), static_cast<unsigned long long>(percentile(0.99))
+		, static_cast<unsigned long long>(percentile(0.999)), static_cast<unsigned long long>(roundTrips.back()));
+}
+
+bool parsePair(const char* text, std::pair<int, int>& pair) {
+	return std::sscanf(text, "%d:%d", &pair.first, &pair.second) == 2 && pair.first >= 0 && pair.second >= 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+	std::uint64_t items = 10000000;
+	std::vector<std::pair<int, int>> pairs;
+	for (int i = 1; i < argc; ++i) {
+		std::pair<int, int> pair;
+		if (std::strchr(argv[i], ':') && parsePair(argv[i], pair))
+			pairs.push_back(pair);
+		else if (std::strcmp(argv[i], "--help") != 0 && std::atoll(argv[i]) > 0)
+			items = static_cast<std::uint64_t>(std::atoll(argv[i]));
+		else {
+			std::printf("usage: %s [items] [producer-cpu:consumer-cpu ...]\n", argv[0]);
+			return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+		}
+	}
+	if (pairs.empty())
+		pairs.emplace_back(NO_CPU, NO_CPU);
+
+	const std::uint64_t samples = std::max<std::uint64_t>(items / 100, 1000);
+	std::printf("%llu items, capacity %zu, batches of %zu, %llu latency samples\n"
+		, static_cast<unsigned long long>(items), CAPACITY, BATCH_SIZE, static_cast<unsigned long long>(samples));
+	for (const std::pair<int, int>& pair : pairs) {
+		if (pair.first == NO_CPU)
+			std::printf("unpinned\n");
+		else
+			std::printf("producer on cpu %d, consumer on cpu %d\n", pair.first, pair.second);
+		runPair<util::SpscQueue<std::uint64_t>>("spsc", items, pair.first, pair.second, false);
+		runPair<util::SpscQueue<std::uint64_t>>("spsc batch", items, pair.first, pair.second, true);
+		runPair<util::MpmcQueue<std::uint64_t>>("mpmc 1p/1c", items, pair.first, pair.second, false);
+		runPair<util::MpmcQueue<std::uint64_t>>("mpmc 1p/1c batch", items, pair.first, pair.second, true);
+		runPingPong<util::SpscQueue<std::uint64_t>>("spsc round trip", samples, pair.first, pair.second);
+		runPingPong<util::MpmcQueue<std::uint64_t>>("mpmc round trip", samples, pair.first, pair.second);
+	}
+
+	const unsigned threads = std::max(2u, std::thread::hardware_concurrency());
+	std::printf("%u threads, unpinned\n", threads);
+	runMpmc(items, threads / 2, threads - threads / 2);
+	return 0;
+}
@@ -0,0 +1,203 @@
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OptionalAlgorithms.h"
+
+#include "Check.h"
+
+namespace {
+
+struct Tracked {
+	static int live;
+	static int copiesUntilThrow;
+
+	explicit Tracked(int value) : value(value) { ++live; }
+
+	Tracked(const Tracked& other) : value(other.value) {
+		if (copiesUntilThrow == 0)
+			throw std::runtime_error("copy failed");
+		--copiesUntilThrow;
+		++live;
+	}
+
+	~Tracked() { --live; }
+
+	int value;
+};
+
+int Tracked::live = 0;
+int Tracked::copiesUntilThrow = -1;
+
+using SentinelInt = util::Optional<int, util::SentinelOptionalPolicy<int, -1>>;
+using ZeroSentinelInt = util::Optional<int, util::SentinelOptionalPolicy<int, 0>>;
+
+static_assert(util::IsZeroEmptyPolicy<util::DefaultOptionalPolicy<int>>::value, "");
+static_assert(util::IsZeroEmptyPolicy<util::SentinelOptionalPolicy<int, 0>>::value, "");
+static_assert(!util::IsZeroEmptyPolicy<util::SentinelOptionalPolicy<int, -1>>::value, "");
+static_assert(!util::IsZeroEmptyPolicy<util::BoolOptionalPolicy>::value, "");
+static_assert(util::IsZeroEmptyPolicy<util::LikelyEmpty<util::DefaultOptionalPolicy<int>>>::value, "");
+
+// Only trivially copyable optionals come into existence by writing bytes.
+static_assert(util::details::ZERO_FILLABLE_OPTIONAL<int, util::DefaultOptionalPolicy<int>>, "");
+static_assert(!util::details::ZERO_FILLABLE_OPTIONAL<std::string, util::DefaultOptionalPolicy<std::string>>, "");
+
+// Raw storage for count optionals, filled with garbage.
+template <typename O>
+struct RawBuffer {
+	explicit RawBuffer(std::size_t count)
+		: bytes(new unsigned char[count * sizeof(O)]), count(count) {
+		for (std::size_t i = 0; i != count * sizeof(O); ++i)
+			bytes[i] = 0xa5;
+	}
+
+	O* begin() { return reinterpret_cast<O*>(bytes.get()); }
+	O* end() { return begin() + count; }
+
+	std::unique_ptr<unsigned char[]> bytes;
+	std::size_t count;
+};
+
+template <typename O>
+void testFillNullopt() {
+	RawBuffer<O> buffer(100);
+	util::uninitializedFillNullopt(buffer.begin(), buffer.end());
+	for (const O& o : buffer)
+		CHECK(!o);
+}
+
+template <typename O>
+void testResetAllTrivial() {
+	std::vector<O> values(130);
+	for (std::size_t i = 0; i < values.size(); i += 3)
+		values[i] = static_cast<int>(i) + 1;
+	util::resetAll(values.data(), values.data() + values.size());
+	for (const O& o : values)
+		CHECK(!o);
+}
+
+void testResetAllAndDestroyNonTrivial() {
+	{
+		std::vector<util::Optional<Tracked>> values(130);
+		for (std::size_t i = 0; i < values.size(); i += 2)
+			values[i].emplace(static_cast<int>(i));
+		CHECK(Tracked::live == 65);
+		util::resetAll(values.data(), values.data() + 64);
+		CHECK(Tracked::live == 33);
+		for (std::size_t i = 0; i != 64; ++i)
+			CHECK(!values[i]);
+		CHECK(values[64] && (*values[64]).value == 64);
+	}
+	CHECK(Tracked::live == 0);
+
+	RawBuffer<util::Optional<Tracked>> buffer(70);
+	util::uninitializedFillNullopt(buffer.begin(), buffer.end());
+	for (std::size_t i = 5; i < 70; i += 5)
+		buffer.begin()[i].emplace(static_cast<int>(i));
+	CHECK(Tracked::live == 13);
+	util::destroyRange(buffer.begin(), buffer.end());
+	CHECK(Tracked::live == 0);
+}
+
+void testUninitializedCopy() {
+	const std::vector<util::Optional<int>> source{1, util::nullopt, 3};
+	RawBuffer<util::Optional<int>> ints(3);
+	CHECK(util::uninitializedCopy(source.data(), source.data() + 3, ints.begin()) == ints.end());
+	CHECK(*ints.begin()[0] == 1 && !ints.begin()[1] && *ints.begin()[2] == 3);
+
+	const std::vector<util::Optional<std::string>> strings{std::string("a"), util::nullopt, std::string("c")};
+	RawBuffer<util::Optional<std::string>> copies(3);
+	util::uninitializedCopy(strings.data(), strings.data() + 3, copies.begin());
+	CHECK(*copies.begin()[0] == "a" && !copies.begin()[1] && *copies.begin()[2] == "c");
+	util::destroyRange(copies.begin(), copies.end());
+}
+
+void testUninitializedCopyThrowing() {
+	{
+		std::vector<util::Optional<Tracked>> source;
+		for (int i = 0; i != 5; ++i)
+			source.emplace_back(util::inPlace, i);
+		RawBuffer<util::Optional<Tracked>> buffer(5);
+		Tracked::copiesUntilThrow = 3;
+		CHECK_THROWS(util::uninitializedCopy(source.data(), source.data() + 5, buffer.begin()), std::runtime_error);
+		Tracked::copiesUntilThrow = -1;
+		CHECK(Tracked::live == 5);
+	}
+	CHECK(Tracked::live == 0);
+}
+
+void testSwap() {
+	util::Optional<std::string> a("a");
+	util::Optional<std::string> b;
+	a.swap(b);
+	CHECK(!a && *b == "a");
+	swap(a, b);
+	CHECK(*a == "a" && !b);
+	b = std::string("b");
+	a.swap(b);
+	CHECK(*a == "b" && *b == "a");
+	b.reset();
+	a.reset();
+	a.swap(b);
+	CHECK(!a && !b);
+
+	static_assert(noexcept(a.swap(b)), "");
+}
+
+template <typename O, typename Make>
+void testSwapRanges(Make make) {
+	// Long enough to cross several byte blocks in the bitwise path.
+	constexpr std::size_t COUNT = 300;
+	std::vector<O> a(COUNT);
+	std::vector<O> b(COUNT);
+	for (std::size_t i = 0; i != COUNT; ++i) {
+		if (i % 3 != 0)
+			a[i] = make(i);
+		if (i % 2 != 0)
+			b[i] = make(i + COUNT);
+	}
+	util::swapRanges(a.data(), a.data() + COUNT, b.data());
+	for (std::size_t i = 0; i != COUNT; ++i) {
+		CHECK(static_cast<bool>(a[i]) == (i % 2 != 0) && (!a[i] || *a[i] == make(i + COUNT)));
+		CHECK(static_cast<bool>(b[i]) == (i % 3 != 0) && (!b[i] || *b[i] == make(i)));
+	}
+}
+
+void testMoveAssignRange() {
+	std::vector<util::Optional<int>> ints{1, util::nullopt, 3, 4};
+	CHECK(util::moveAssignRange(ints.data() + 1, ints.data() + 4, ints.data()) == ints.data() + 3);
+	CHECK(!ints[0] && *ints[1] == 3 && *ints[2] == 4);
+
+	std::vector<util::Optional<std::unique_ptr<int>>> source(3);
+	source[0] = std::make_unique<int>(1);
+	source[2] = std::make_unique<int>(3);
+	std::vector<util::Optional<std::unique_ptr<int>>> dest(3);
+	dest[1] = std::make_unique<int>(2);
+	util::moveAssignRange(source.data(), source.data() + 3, dest.data());
+	CHECK(**dest[0] == 1 && !dest[1] && **dest[2] == 3);
+	CHECK(source[0] && !*source[0]);
+}
+
+} // namespace
+
+int main() {
+	testSwap();
+	testSwapRanges<util::Optional<int>>([](std::size_t i) { return static_cast<int>(i); });
+	testSwapRanges<SentinelInt>([](std::size_t i) { return static_cast<int>(i); });
+	testSwapRanges<util::Optional<std::string>>([](std::size_t i) { return std::to_string(i); });
+	testMoveAssignRange();
+	testFillNullopt<util::Optional<int>>();
+	testFillNullopt<SentinelInt>();
+	testFillNullopt<ZeroSentinelInt>();
+	testFillNullopt<util::Optional<bool>>();
+	testFillNullopt<util::Optional<std::string>>();
+	testResetAllTrivial<util::Optional<int>>();
+	testResetAllTrivial<SentinelInt>();
+	testResetAllAndDestroyNonTrivial();
+	testUninitializedCopy();
+	testUninitializedCopyThrowing();
+	return 0;
+}
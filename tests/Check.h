@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Unlike assert, stays active in release builds.
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			std::abort(); \
+		} \
+	} while (false)
+
+#define CHECK_THROWS(expression, Exception) \
+	do { \
+		bool thrown = false; \
+		try { \
+			(void)(expression); \
+		} \
+		catch (const Exception&) { \
+			thrown = true; \
+		} \
+		CHECK(thrown && #expression " throws " #Exception); \
+	} while (false)
@@ -0,0 +1,84 @@
+# Usage: cmake -DSOURCE=Codegen.cpp -DASM=Codegen.s -P CheckCodegen.cmake
+#
+# Reads the "// EXPECT:" comment in front of every function in SOURCE and
+# checks the function's body in the AT&T assembly ASM against it.
+
+file(STRINGS "${SOURCE}" sourceLines)
+set(pending "")
+set(functions "")
+foreach(line IN LISTS sourceLines)
+	if(line MATCHES "^// EXPECT: (.*)$")
+		set(pending "${CMAKE_MATCH_1}")
+	elseif(pending AND line MATCHES "^[A-Za-z_].* ([A-Za-z_][A-Za-z0-9_]*)\\(")
+		set(function "${CMAKE_MATCH_1}")
+		list(APPEND functions ${function})
+		set(expect_${function} "${pending}")
+		set(pending "")
+	endif()
+endforeach()
+
+file(STRINGS "${ASM}" asmLines)
+set(current "")
+foreach(line IN LISTS asmLines)
+	if(line MATCHES "^_?([A-Za-z_][A-Za-z0-9_.]*):")
+		set(current "${CMAKE_MATCH_1}")
+		set(count_${current} 0)
+		set(branches_${current} "")
+		set(calls_${current} "")
+		set(memory_${current} "")
+	elseif(current AND line MATCHES "^[ \t]+([a-z][a-z0-9]*)([ \t]+(.*))?$")
+		set(mnemonic "${CMAKE_MATCH_1}")
+		set(operands "${CMAKE_MATCH_3}")
+		math(EXPR count_${current} "${count_${current}} + 1")
+		if(mnemonic MATCHES "^j")
+			list(APPEND branches_${current} "${mnemonic}")
+		endif()
+		if(mnemonic MATCHES "^call")
+			list(APPEND calls_${current} "${operands}")
+		endif()
+		if(operands MATCHES "\\(%")
+			list(APPEND memory_${current} "${mnemonic}")
+		endif()
+	endif()
+endforeach()
+
+set(failures 0)
+foreach(function IN LISTS functions)
+	if(NOT DEFINED count_${function})
+		message(SEND_ERROR "${function}: not found in ${ASM}")
+		math(EXPR failures "${failures} + 1")
+		continue()
+	endif()
+	separate_arguments(expectations UNIX_COMMAND "${expect_${function}}")
+	set(problems "")
+	list(LENGTH expectations expectationCount)
+	set(i 0)
+	while(i LESS expectationCount)
+		list(GET expectations ${i} expectation)
+		if(expectation STREQUAL "NO_BRANCH" AND branches_${function})
+			list(APPEND problems "branches (${branches_${function}})")
+		elseif(expectation STREQUAL "NO_CALL" AND calls_${function})
+			list(APPEND problems "calls (${calls_${function}})")
+		elseif(expectation STREQUAL "NO_MEMORY" AND memory_${function})
+			list(APPEND problems "memory operands (${memory_${function}})")
+		elseif(expectation STREQUAL "MAX")
+			math(EXPR i "${i} + 1")
+			list(GET expectations ${i} limit)
+			if(count_${function} GREATER limit)
+				list(APPEND problems "${count_${function}} instructions, expected at most ${limit}")
+			endif()
+		endif()
+		math(EXPR i "${i} + 1")
+	endwhile()
+	if(problems)
+		string(REPLACE ";" ", " problems "${problems}")
+		message(SEND_ERROR "${function}: ${problems}")
+		math(EXPR failures "${failures} + 1")
+	else()
+		message(STATUS "${function}: ${count_${function}} instructions, ok")
+	endif()
+endforeach()
+
+if(failures)
+	message(FATAL_ERROR "${failures} codegen check(s) failed")
+endif()
@@ -0,0 +1,128 @@
+// Functions whose optimized assembly is checked by CheckCodegen.cmake. Each
+// function is preceded by the properties its body must have:
+//   NO_BRANCH  no conditional or unconditional jumps
+//   NO_CALL    no calls
+//   NO_MEMORY  no memory operands, i.e. arguments arrive in registers
+//   MAX n      at most n instructions, including the return
+
+#include <string>
+
+#include "Optional.h"
+
+using IntOptional = util::Optional<int>;
+using SentinelIntOptional = util::Optional<int, util::SentinelOptionalPolicy<int, -1>>;
+using DoubleOptional = util::Optional<double>;
+using BoolOptional = util::Optional<bool>;
+
+extern "C" {
+
+// EXPECT: NO_BRANCH NO_CALL MAX 3
+bool codegenHasValue(const IntOptional& o) {
+	return o.hasValue();
+}
+
+// EXPECT: NO_BRANCH NO_CALL NO_MEMORY MAX 3
+bool codegenByValueHasValue(IntOptional o) {
+	return static_cast<bool>(o);
+}
+
+// EXPECT: NO_BRANCH NO_CALL NO_MEMORY MAX 4
+bool codegenSentinelByValueHasValue(SentinelIntOptional o) {
+	return static_cast<bool>(o);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 3
+void codegenCopyAssign(IntOptional& lhs, const IntOptional& rhs) {
+	lhs = rhs;
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 3
+void codegenCopyConstruct(IntOptional* out, const IntOptional& from) {
+	::new (out) IntOptional(from);
+}
+
+// EXPECT: NO_CALL MAX 4
+void codegenReset(IntOptional& o) {
+	o.reset();
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 4
+bool codegenEqualsNullopt(const IntOptional& o) {
+	return o == util::nullopt;
+}
+
+// EXPECT: NO_CALL MAX 12
+bool codegenEquals(const IntOptional& lhs, const IntOptional& rhs) {
+	return lhs == rhs;
+}
+
+// EXPECT: NO_CALL MAX 12
+bool codegenNotEquals(const IntOptional& lhs, const IntOptional& rhs) {
+	return lhs != rhs;
+}
+
+// EXPECT: NO_CALL MAX 10
+bool codegenLessThanValue(const IntOptional& lhs, int rhs) {
+	return lhs < rhs;
+}
+
+// The throw is kept in a separate cold section.
+// EXPECT: NO_CALL MAX 5
+int codegenValue(const IntOptional& o) {
+	return o.value();
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 8
+int codegenValueOr(const IntOptional& o, int fallback) {
+	return o.valueOr(fallback);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 8
+int codegenSentinelValueOr(const SentinelIntOptional& o, int fallback) {
+	return o.valueOr(fallback);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 10
+double codegenDoubleValueOr(const DoubleOptional& o, double fallback) {
+	return o.valueOr(fallback);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 10
+bool codegenBoolValueOr(const BoolOptional& o, bool fallback) {
+	return o.valueOr(fallback);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 8
+int codegenValueOrDefault(const IntOptional& o) {
+	return o.valueOrDefault();
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 8
+long codegenSelect(const IntOptional& o, long ifEngaged, long ifEmpty) {
+	return o.select(ifEngaged, ifEmpty);
+}
+
+// EXPECT: NO_BRANCH NO_CALL MAX 12
+double codegenDoubleSelect(const IntOptional& o, double ifEngaged, double ifEmpty) {
+	return o.select(ifEngaged, ifEmpty);
+}
+
+// Constructing an empty optional zeroes the payload along with the flag.
+// EXPECT: NO_BRANCH NO_CALL MAX 3
+void codegenConstructEmpty(IntOptional* out) {
+	::new (out) IntOptional();
+}
+
+// Destroying the string is moved to a cold function.
+// EXPECT: NO_CALL MAX 3
+void codegenLikelyEmptyReset(util::LikelyEmptyOptional<std::string>& o) {
+	o.reset();
+}
+
+// Constructing the string is moved to a cold function; assignment tail calls.
+// EXPECT: NO_CALL MAX 6
+void codegenLikelyEngagedAssign(util::LikelyEngagedOptional<std::string>& o, const std::string& value) {
+	o = value;
+}
+
+} // extern "C"
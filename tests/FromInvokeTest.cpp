@@ -0,0 +1,40 @@
+// Payloads that can be neither copied nor moved rely on the guaranteed copy
+// elision of C++17, so this test is built with C++17 while the rest of the
+// library targets C++14.
+
+#include <atomic>
+#include <mutex>
+
+#include "Optional.h"
+
+#include "Check.h"
+
+namespace {
+
+struct NonMovable {
+	explicit NonMovable(int value) : value(value) {}
+	NonMovable(const NonMovable&) = delete;
+	NonMovable(NonMovable&&) = delete;
+
+	std::mutex mutex;
+	int value;
+};
+
+NonMovable make(int value) {
+	return NonMovable(value);
+}
+
+} // namespace
+
+int main() {
+	util::Optional<NonMovable> made(util::fromInvoke, make, 1);
+	CHECK(made && (*made).value == 1);
+
+	util::Optional<NonMovable> emplaced;
+	CHECK(emplaced.emplaceWith(make, 3).value == 3);
+	CHECK(emplaced.emplaceWith(make, 4).value == 4);
+
+	util::Optional<std::atomic<int>> counter(util::fromInvoke, [] { return std::atomic<int>(5); });
+	CHECK(counter && (*counter).load() == 5);
+	return 0;
+}
@@ -0,0 +1,90 @@
+// Layout and ABI properties of the shipped policies that callers depend on.
+// The checks run at compile time; building this file is the test.
+
+#include <type_traits>
+
+#include "Optional.h"
+
+namespace {
+
+enum class Id : int {};
+
+// Stands in for a user type that opts into a sentinel through OptionalTraits.
+enum class Colour : unsigned char { RED, GREEN, NONE = 0xff };
+
+} // namespace
+
+namespace util {
+
+template <>
+struct OptionalTraits<Colour> {
+	using Policy = SentinelOptionalPolicy<Colour, Colour::NONE>;
+};
+
+} // namespace util
+
+namespace {
+
+template <typename T, typename Policy>
+constexpr bool REGISTER_PASSABLE = std::is_trivially_copyable<util::Optional<T, Policy>>::value
+	&& std::is_trivially_destructible<util::Optional<T, Policy>>::value;
+
+using IntDefault = util::DefaultOptionalPolicy<int>;
+using IntSentinel = util::SentinelOptionalPolicy<int, -1>;
+using IdSentinel = util::SentinelOptionalPolicy<Id, Id(-1)>;
+
+// DefaultOptionalPolicy adds one flag, padded to the payload alignment.
+static_assert(util::OptionalLayout<int, IntDefault>::overhead() == alignof(int), "");
+static_assert(util::OptionalLayout<int, IntDefault>::alignment() == alignof(int), "");
+static_assert(util::OptionalLayout<double, util::DefaultOptionalPolicy<double>>::overhead() == alignof(double), "");
+
+// Sentinel and bool policies add nothing.
+static_assert(util::OptionalLayout<int, IntSentinel>::compact(), "");
+static_assert(util::OptionalLayout<int, IntSentinel>::alignment() == alignof(int), "");
+static_assert(util::OptionalLayout<Id, IdSentinel>::compact(), "");
+static_assert(util::OptionalLayout<bool>::compact(), "");
+
+// OptionalTraits picks BoolOptionalPolicy for bool and the flag otherwise.
+static_assert(std::is_same<util::OptionalLayout<bool>::ChosenPolicy, util::BoolOptionalPolicy>::value, "");
+static_assert(std::is_same<util::OptionalLayout<int>::ChosenPolicy, IntDefault>::value, "");
+
+// A user specialization of OptionalTraits is picked up by Optional, by
+// makeOptional and by the hinted aliases.
+using ColourPolicy = util::SentinelOptionalPolicy<Colour, Colour::NONE>;
+static_assert(std::is_same<util::Optional<Colour>, util::Optional<Colour, ColourPolicy>>::value, "");
+static_assert(std::is_same<decltype(util::makeOptional(Colour::RED)), util::Optional<Colour, ColourPolicy>>::value, "");
+static_assert(std::is_same<decltype(util::makeOptional<Colour>(Colour::RED)), util::Optional<Colour, ColourPolicy>>::value, "");
+static_assert(std::is_same<util::OptionalLayout<Colour>::ChosenPolicy, ColourPolicy>::value, "");
+static_assert(sizeof(util::Optional<Colour>) == sizeof(Colour), "");
+static_assert(sizeof(util::LikelyEmptyOptional<Colour>) == sizeof(Colour), "");
+static_assert(REGISTER_PASSABLE<Colour, ColourPolicy>, "");
+
+// Hint wrappers do not change the layout.
+static_assert(sizeof(util::LikelyEngagedOptional<int>) == sizeof(util::Optional<int>), "");
+static_assert(sizeof(util::LikelyEmptyOptional<bool>) == 1, "");
+
+// Trivial payloads keep every shipped policy trivially copyable and
+// destructible, so the optional is passed and returned in registers.
+static_assert(REGISTER_PASSABLE<int, IntDefault>, "");
+static_assert(REGISTER_PASSABLE<double, util::DefaultOptionalPolicy<double>>, "");
+static_assert(REGISTER_PASSABLE<int, IntSentinel>, "");
+static_assert(REGISTER_PASSABLE<Id, IdSentinel>, "");
+static_assert(REGISTER_PASSABLE<bool, util::BoolOptionalPolicy>, "");
+static_assert(REGISTER_PASSABLE<int, util::LikelyEngaged<IntDefault>>, "");
+static_assert(REGISTER_PASSABLE<int, util::LikelyEmpty<IntDefault>>, "");
+
+// Copy and move follow the payload.
+struct MoveOnly {
+	MoveOnly(MoveOnly&&) = default;
+	MoveOnly& operator =(MoveOnly&&) = default;
+};
+
+static_assert(!std::is_copy_constructible<util::Optional<MoveOnly>>::value, "");
+static_assert(std::is_move_constructible<util::Optional<MoveOnly>>::value, "");
+static_assert(!std::is_copy_assignable<util::Optional<const int>>::value, "");
+
+} // namespace
+
+int main() {
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "Optional.h"
+
+#include "Check.h"
+
+namespace {
+
+void testComparisons() {
+	const util::Optional<int> empty;
+	const util::Optional<int> one(1);
+	const util::Optional<int> two(2);
+
+	CHECK(empty == util::Optional<int>());
+	CHECK(one == util::Optional<int>(1));
+	CHECK(one != two);
+	CHECK(one != empty);
+	CHECK(!(empty != util::Optional<int>()));
+	CHECK(empty < one && one < two && !(two < one));
+	CHECK(two > one && one >= one && one <= two);
+
+	CHECK(empty == util::nullopt && util::nullopt == empty);
+	CHECK(one != util::nullopt && util::nullopt != one);
+
+	CHECK(one == 1 && 1 == one && one != 2 && empty != 1);
+	CHECK(empty < 1 && one < 2 && 2 > one);
+}
+
+void testTriviallyCopyableCopies() {
+	util::Optional<int> a(5);
+	util::Optional<int> b(a);
+	CHECK(b && *b == 5);
+
+	util::Optional<int> c;
+	b = c;
+	CHECK(!b);
+	c = a;
+	CHECK(c && *c == 5);
+}
+
+void testNonTrivialCopies() {
+	util::Optional<std::string> a("hello");
+	util::Optional<std::string> b(a);
+	CHECK(b && *b == "hello");
+
+	util::Optional<std::string> empty;
+	b = empty;
+	CHECK(!b);
+	empty = util::Optional<std::string>();
+	CHECK(!empty);
+
+	util::Optional<std::string> c(std::move(a));
+	CHECK(c && *c == "hello");
+}
+
+// The integral select stays usable in constant expressions.
+static_assert(util::details::select(true, 1, 2) == 1, "");
+static_assert(util::details::select(false, std::int64_t(1), std::int64_t(-2)) == -2, "");
+
+void testValueOr() {
+	const util::Optional<int> empty;
+	const util::Optional<int> one(1);
+	CHECK(empty.valueOr(7) == 7);
+	CHECK(one.valueOr(7) == 1);
+	CHECK(empty.valueOrDefault() == 0);
+	CHECK(one.valueOrDefault() == 1);
+
+	util::Optional<int> reset(5);
+	reset.reset();
+	CHECK(reset.valueOr(-3) == -3);
+
+	const util::Optional<double> half(0.5);
+	CHECK(half.valueOr(2.0) == 0.5);
+	CHECK(util::Optional<double>().valueOr(2.0) == 2.0);
+
+	const util::Optional<int, util::SentinelOptionalPolicy<int, -1>> sentinel;
+	CHECK(sentinel.valueOr(4) == 4);
+
+	CHECK(util::Optional<bool>().valueOr(true));
+	CHECK(!util::Optional<bool>(false).valueOr(true));
+
+	CHECK(util::Optional<std::string>().valueOr("fallback") == "fallback");
+	CHECK(util::Optional<std::string>("value").valueOr("fallback") == "value");
+
+	int calls = 0;
+	const auto fallback = [&calls] { ++calls; return 9; };
+	CHECK(one.valueOrElse(fallback) == 1 && calls == 0);
+	CHECK(empty.valueOrElse(fallback) == 9 && calls == 1);
+}
+
+void testSelect() {
+	const util::Optional<std::string> empty;
+	const util::Optional<std::string> full("x");
+	CHECK(empty.select(1, 2) == 2);
+	CHECK(full.select(1, 2) == 1);
+	CHECK(full.select(1.5, 2.5) == 1.5);
+	CHECK(empty.select(std::string("a"), std::string("b")) == "b");
+}
+
+void testHintedPolicies() {
+	util::LikelyEngagedOptional<std::string> engaged;
+	engaged = std::string("a");
+	CHECK(engaged && *engaged == "a");
+	util::LikelyEngagedOptional<std::string> copy;
+	copy = engaged;
+	CHECK(copy && *copy == "a");
+
+	util::LikelyEmptyOptional<std::string> empty(std::string("b"));
+	empty.reset();
+	CHECK(!empty);
+	empty.reset();
+	CHECK(!empty);
+}
+
+// Counts copies and moves so that tests can tell whether a factory result was
+// constructed in place.
+struct Counted {
+	static int copies;
+	static int moves;
+
+	explicit Counted(int value) : value(value) {}
+	Counted(const Counted& other) : value(other.value) { ++copies; }
+	Counted(Counted&& other) noexcept : value(other.value) { ++moves; }
+
+	int value;
+};
+
+int Counted::copies = 0;
+int Counted::moves = 0;
+
+void testFromInvoke() {
+	const auto make = [](int value) { return Counted(value); };
+	Counted::copies = Counted::moves = 0;
+	const util::Optional<Counted> made(util::fromInvoke, make, 3);
+	CHECK(made && (*made).value == 3);
+	util::Optional<Counted> emplaced;
+	CHECK(emplaced.emplaceWith(make, 4).value == 4);
+	CHECK(emplaced.emplaceWith(make, 5).value == 5);
+	// Before C++17 the compiler may move the result instead of eliding it.
+	CHECK(Counted::copies == 0);
+#if __cplusplus >= 201703L
+	CHECK(Counted::moves == 0);
+#endif
+
+	const util::Optional<std::unique_ptr<int>> owner(util::fromInvoke, [] { return std::make_unique<int>(6); });
+	CHECK(owner && **owner == 6);
+}
+
+void testFromInvokeLargePayload() {
+	using Page = std::array<unsigned char, 1 << 16>;
+	const auto fill = [](unsigned char byte) {
+		Page page;
+		page.fill(byte);
+		return page;
+	};
+	util::Optional<Page> page(util::fromInvoke, fill, static_cast<unsigned char>(7));
+	CHECK(page && (*page)[0] == 7 && (*page)[(*page).size() - 1] == 7);
+	page.emplaceWith(fill, static_cast<unsigned char>(8));
+	CHECK((*page)[12345] == 8);
+}
+
+void testEmplaceWithThrowing() {
+	const auto fail = []() -> std::string { throw std::runtime_error("factory failed"); };
+	util::Optional<std::string> value("kept");
+	CHECK_THROWS(value.emplaceWith(fail), std::runtime_error);
+	CHECK(!value);
+
+	util::Optional<int, util::SentinelOptionalPolicy<int, -1>> sentinel(1);
+	CHECK_THROWS(sentinel.emplaceWith([]() -> int { throw std::runtime_error("factory failed"); }), std::runtime_error);
+	CHECK(!sentinel);
+}
+
+} // namespace
+
+int main() {
+	testFromInvoke();
+	testFromInvokeLargePayload();
+	testEmplaceWithThrowing();
+	testHintedPolicies();
+	testValueOr();
+	testSelect();
+	testComparisons();
+	testTriviallyCopyableCopies();
+	testNonTrivialCopies();
+	return 0;
+}
@@ -0,0 +1,199 @@
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+#include "DelimitedParser.h"
+
+#include "Check.h"
+
+namespace {
+
+std::size_t allocations = 0;
+
+} // namespace
+
+// Counts every heap allocation made by the test.
+void* operator new(std::size_t size) {
+	++allocations;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+
+using Parser = util::DelimitedParser<std::int64_t, double>;
+
+void feed(Parser& parser, const char* text) {
+	parser.feed(text, std::strlen(text));
+}
+
+bool hasRow(const Parser& parser, std::size_t row, std::int64_t a, double b) {
+	const auto& first = parser.column<0>()[row];
+	const auto& second = parser.column<1>()[row];
+	return first && *first == a && second && *second == b;
+}
+
+void testRecordsAndEmptyFields() {
+	Parser parser;
+	feed(parser, "1,2.5\n,3\r\n-4,\n,\n");
+	CHECK(parser.rows() == 4);
+	CHECK(hasRow(parser, 0, 1, 2.5));
+	CHECK(!parser.column<0>()[1] && *parser.column<1>()[1] == 3.0);
+	CHECK(*parser.column<0>()[2] == -4 && !parser.column<1>()[2]);
+	CHECK(!parser.column<0>()[3] && !parser.column<1>()[3]);
+}
+
+void testChunkBoundaries() {
+	const std::string text = "12,0.25\n-7,1e3\n9223372036854775807,-.5\n3,4";
+	for (std::size_t split = 0; split <= text.size(); ++split) {
+		Parser parser;
+		parser.feed(text.data(), split);
+		parser.feed(text.data() + split, text.size() - split);
+		parser.finish();
+		CHECK(parser.rows() == 4);
+		CHECK(hasRow(parser, 0, 12, 0.25));
+		CHECK(hasRow(parser, 1, -7, 1000.0));
+		CHECK(hasRow(parser, 2, INT64_MAX, -0.5));
+		CHECK(hasRow(parser, 3, 3, 4.0));
+	}
+}
+
+void testMalformedRecordKeepsTrailingPartial() {
+	Parser parser;
+	CHECK_THROWS(feed(parser, "1,2\nx,3\n4"), util::ParseError);
+	feed(parser, "5,6\n");
+	CHECK(parser.rows() == 2);
+	CHECK(hasRow(parser, 0, 1, 2.0));
+	CHECK(hasRow(parser, 1, 45, 6.0));
+}
+
+void testMalformedRecordSkipsOnlyItself() {
+	Parser parser;
+	CHECK_THROWS(feed(parser, "1,1\n2\n3,3\n4,4,4\n5,5\n"), util::ParseError);
+	CHECK(parser.rows() == 3);
+	CHECK(hasRow(parser, 1, 3, 3.0));
+	CHECK(hasRow(parser, 2, 5, 5.0));
+
+	// A bad record completed from the carry is skipped the same way.
+	feed(parser, "6,");
+	CHECK_THROWS(feed(parser, "x\n7,7\n"), util::ParseError);
+	CHECK(parser.rows() == 4);
+	CHECK(hasRow(parser, 3, 7, 7.0));
+}
+
+void testFinish() {
+	Parser parser;
+	feed(parser, "1,2");
+	CHECK(parser.rows() == 0);
+	parser.finish();
+	CHECK(parser.rows() == 1);
+	parser.finish();
+	CHECK(parser.rows() == 1);
+
+	feed(parser, "x,2");
+	CHECK_THROWS(parser.finish(), util::ParseError);
+	parser.finish();
+	CHECK(parser.rows() == 1);
+}
+
+void testIntegerValidation() {
+	const char* const invalid[] = {"+", "-", "1a", " 1", "1 ", "9223372036854775808", "-9223372036854775809", "0x10"};
+	for (const char* field : invalid) {
+		util::Optional<std::int64_t> value;
+		CHECK_THROWS(util::details::parseValue(field, field + std::strlen(field), value), util::ParseError);
+		CHECK(!value);
+	}
+	util::Optional<std::int64_t> value;
+	const char minimum[] = "-9223372036854775808";
+	util::details::parseValue(minimum, minimum + sizeof(minimum) - 1, value);
+	CHECK(value && *value == INT64_MIN);
+}
+
+void testFloatingPointValidation() {
+	const char* const invalid[] = {"inf", "-infinity", "nan", "0x1p3", " 1", "1 ", "1,5", ".", "-", "1e", "1e+"
+		, "e5", "1.2.3", "1e400", "0.1234567890123456789012345678901234567890123456789012345678901234567890"};
+	for (const char* field : invalid) {
+		util::Optional<double> value;
+		CHECK_THROWS(util::details::parseValue(field, field + std::strlen(field), value), util::ParseError);
+		CHECK(!value);
+	}
+
+	const struct {
+		const char* text;
+		double value;
+	} valid[] = {{"0", 0.0}, {"-0.0", -0.0}, {"+1.5", 1.5}, {"1.", 1.0}, {".25", 0.25}, {"0.1", 0.1}
+		, {"2.5e-3", 2.5e-3}, {"1E10", 1e10}, {"1e23", 1e23}, {"123456789012345678901234", 123456789012345678901234.0}
+		, {"0.000000000000000000000000001", 1e-27}, {"4.9e-324", 4.9e-324}};
+	for (const auto& field : valid) {
+		util::Optional<double> value;
+		util::details::parseValue(field.text, field.text + std::strlen(field.text), value);
+		CHECK(value && *value == field.value);
+	}
+}
+
+// Cells are decoded without allocating, including doubles that need more than
+// the exact fast path, such as %.17g round trip output.
+void testNoAllocationPerCell() {
+	constexpr std::size_t ROWS = 1000;
+	std::string text;
+	for (std::size_t i = 0; i != ROWS; ++i)
+		text += i % 2 ? "1,0.30000000000000004\n" : "-2,1.7976931348623157e308\n";
+	Parser parser;
+	parser.reserve(ROWS);
+	const std::size_t before = allocations;
+	parser.feed(text.data(), text.size());
+	CHECK(allocations == before);
+	CHECK(parser.rows() == ROWS);
+	CHECK(*parser.column<1>()[1] == 0.30000000000000004 && *parser.column<1>()[0] == 1.7976931348623157e308);
+}
+
+// The decimal point stays '.' whatever the global locale is.
+void testLocaleIndependence() {
+	const char* const locales[] = {"de_DE.UTF-8", "de_DE", "fr_FR.UTF-8"};
+	for (const char* name : locales) {
+		if (!std::setlocale(LC_ALL, name))
+			continue;
+		Parser parser;
+		feed(parser, "1,1234567890123456789012.5\n2,0.5\n");
+		CHECK(parser.rows() == 2 && *parser.column<1>()[1] == 0.5);
+		std::setlocale(LC_ALL, "C");
+	}
+}
+
+void testDelimiterAndColumns() {
+	util::DelimitedParser<std::int64_t, std::int64_t, std::int64_t> parser('\t');
+	parser.reserve(4);
+	const char text[] = "1\t2\t3\n";
+	parser.feed(text, sizeof(text) - 1);
+	CHECK(parser.rows() == 1 && *parser.column<2>()[0] == 3);
+	parser.clearColumns();
+	CHECK(parser.rows() == 0 && parser.column<1>().capacity() >= 4);
+}
+
+} // namespace
+
+int main() {
+	testRecordsAndEmptyFields();
+	testChunkBoundaries();
+	testMalformedRecordKeepsTrailingPartial();
+	testMalformedRecordSkipsOnlyItself();
+	testFinish();
+	testIntegerValidation();
+	testFloatingPointValidation();
+	testNoAllocationPerCell();
+	testLocaleIndependence();
+	testDelimiterAndColumns();
+	return 0;
+}
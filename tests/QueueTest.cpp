@@ -0,0 +1,197 @@
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "OptionalQueue.h"
+
+#include "Check.h"
+
+namespace {
+
+// Counts live instances so that tests can tell whether the queues leak or
+// destroy twice.
+struct Tracked {
+	static int live;
+
+	explicit Tracked(int value) noexcept : value(value) { ++live; }
+	Tracked(const Tracked& other) noexcept : value(other.value) { ++live; }
+	Tracked(Tracked&& other) noexcept : value(other.value) { ++live; }
+	~Tracked() { --live; }
+	Tracked& operator =(const Tracked&) = default;
+
+	int value;
+};
+
+int Tracked::live = 0;
+
+// Output iterator target whose assignment throws after a given number of
+// successful assignments.
+struct ThrowingSink {
+	std::vector<int>* values;
+	std::size_t remaining;
+
+	struct Proxy {
+		ThrowingSink* sink;
+
+		Proxy& operator =(Tracked&& item) {
+			if (sink->remaining == 0)
+				throw std::runtime_error("sink full");
+			--sink->remaining;
+			sink->values->push_back(item.value);
+			return *this;
+		}
+	};
+
+	Proxy operator *() { return Proxy{this}; }
+	ThrowingSink& operator ++() { return *this; }
+};
+
+template <typename Queue>
+void testSingleThreaded() {
+	Queue queue(3);
+	CHECK(queue.capacity() == 4);
+	CHECK(!queue.tryPop());
+	for (int i = 0; i != 4; ++i)
+		CHECK(queue.tryPush(i));
+	CHECK(!queue.tryPush(4));
+	for (int i = 0; i != 4; ++i) {
+		const util::Optional<int> item = queue.tryPop();
+		CHECK(item && *item == i);
+	}
+	CHECK(!queue.tryPop());
+
+	const std::vector<int> input{1, 2, 3, 4, 5, 6};
+	CHECK(queue.tryPushBatch(input.begin(), input.end()) == 4);
+	std::vector<int> output(6, 0);
+	CHECK(queue.tryPopBatch(output.begin(), 3) == 3);
+	CHECK(queue.tryPopBatch(output.begin() + 3, 3) == 1);
+	CHECK((output == std::vector<int>{1, 2, 3, 4, 0, 0}));
+	CHECK(queue.tryPopBatch(output.begin(), 3) == 0);
+}
+
+template <typename Queue>
+void testDestroysRemaining() {
+	{
+		Queue queue(4);
+		queue.tryEmplace(1);
+		queue.tryEmplace(2);
+		CHECK(Tracked::live == 2);
+		queue.tryPop();
+		CHECK(Tracked::live == 1);
+	}
+	CHECK(Tracked::live == 0);
+}
+
+void testSpscMoveOnly() {
+	util::SpscQueue<std::unique_ptr<int>> queue(2);
+	CHECK(queue.tryPush(std::make_unique<int>(3)));
+	const auto item = queue.tryPop();
+	CHECK(item && **item == 3);
+}
+
+void testMpmcPopBatchThrowing() {
+	{
+		util::MpmcQueue<Tracked> queue(8);
+		for (int i = 0; i != 6; ++i)
+			queue.tryEmplace(i);
+		std::vector<int> values;
+		CHECK_THROWS(queue.tryPopBatch(ThrowingSink{&values, 2}, 4), std::runtime_error);
+		CHECK((values == std::vector<int>{0, 1}));
+		// The four claimed elements are gone and their slots are free again.
+		CHECK(Tracked::live == 2);
+		for (int i = 6; i != 12; ++i)
+			CHECK(queue.tryEmplace(i));
+		CHECK(!queue.tryEmplace(12));
+		const util::Optional<Tracked> next = queue.tryPop();
+		CHECK(next && (*next).value == 4);
+	}
+	CHECK(Tracked::live == 0);
+}
+
+void testMpmcConcurrent() {
+	constexpr int PRODUCERS = 3;
+	constexpr int CONSUMERS = 3;
+	constexpr int PER_PRODUCER = 20000;
+	util::MpmcQueue<int> queue(64);
+	std::atomic<long long> sum{0};
+	std::atomic<int> popped{0};
+	std::vector<std::thread> threads;
+	for (int p = 0; p != PRODUCERS; ++p) {
+		threads.emplace_back([&queue, p] {
+			for (int i = 0; i != PER_PRODUCER; ++i) {
+				const int value = p * PER_PRODUCER + i;
+				while (!queue.tryPush(value))
+					std::this_thread::yield();
+			}
+		});
+	}
+	for (int c = 0; c != CONSUMERS; ++c) {
+		threads.emplace_back([&queue, &sum, &popped] {
+			int batch[8];
+			while (popped.load() != PRODUCERS * PER_PRODUCER) {
+				const std::size_t count = queue.tryPopBatch(batch, 8);
+				if (count == 0) {
+					std::this_thread::yield();
+					continue;
+				}
+				sum += std::accumulate(batch, batch + count, 0LL);
+				popped += static_cast<int>(count);
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	const long long n = PRODUCERS * PER_PRODUCER;
+	CHECK(sum.load() == n * (n - 1) / 2);
+}
+
+void testSpscConcurrent() {
+	constexpr int COUNT = 100000;
+	util::SpscQueue<int> queue(16);
+	std::thread producer([&queue] {
+		for (int i = 0; i != COUNT; ++i) {
+			while (!queue.tryPush(i))
+				std::this_thread::yield();
+		}
+	});
+	for (int expected = 0; expected != COUNT;) {
+		const util::Optional<int> item = queue.tryPop();
+		if (!item) {
+			std::this_thread::yield();
+			continue;
+		}
+		CHECK(*item == expected);
+		++expected;
+	}
+	producer.join();
+}
+
+// Capacities past the largest power of two used to loop forever.
+void testRejectsOversizedCapacity() {
+	const std::size_t tooLarge = std::numeric_limits<std::size_t>::max() / 2 + 2;
+	CHECK_THROWS(util::SpscQueue<int>(tooLarge), std::length_error);
+	CHECK_THROWS(util::MpmcQueue<int>(std::numeric_limits<std::size_t>::max()), std::length_error);
+	CHECK(util::details::roundUpToPowerOfTwo(std::numeric_limits<std::size_t>::max() / 2 + 1)
+		== std::numeric_limits<std::size_t>::max() / 2 + 1);
+}
+
+} // namespace
+
+int main() {
+	testRejectsOversizedCapacity();
+	testSingleThreaded<util::SpscQueue<int>>();
+	testSingleThreaded<util::MpmcQueue<int>>();
+	testDestroysRemaining<util::SpscQueue<Tracked>>();
+	testDestroysRemaining<util::MpmcQueue<Tracked>>();
+	testSpscMoveOnly();
+	testMpmcPopBatchThrowing();
+	testMpmcConcurrent();
+	testSpscConcurrent();
+	return 0;
+}
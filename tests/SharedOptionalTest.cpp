@@ -0,0 +1,155 @@
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SharedOptional.h"
+
+#include "Check.h"
+
+namespace {
+
+using Shared = util::SharedOptional<std::string>;
+
+void testEmpty() {
+	Shared empty;
+	CHECK(!empty && empty == util::nullopt && empty.useCount() == 0);
+	CHECK(empty.valueOr("x") == "x");
+	CHECK_THROWS(empty.value(), util::BadOptionalAccess);
+	static_assert(sizeof(Shared) == sizeof(void*), "");
+}
+
+void testCopiesShareUntilWritten() {
+	const Shared a(std::string("hello"));
+	Shared b = a;
+	CHECK(a.useCount() == 2 && b.useCount() == 2);
+	CHECK(&*a == &*static_cast<const Shared&>(b));
+
+	*b += " world";
+	CHECK(*a == "hello" && *b == "hello world");
+	CHECK(a.unique() && b.unique());
+	CHECK(a != b);
+}
+
+void testEscapedReferenceIsNotShared() {
+	Shared a(std::string("one"));
+	std::string& ref = *a;
+	const Shared b = a;
+	ref = "two";
+	CHECK(*b == "one" && *static_cast<const Shared&>(a) == "two");
+	CHECK(a.unique() && b.unique());
+
+	// emplace hands out a reference too.
+	std::string& emplaced = a.emplace("three");
+	const Shared c = a;
+	emplaced = "four";
+	CHECK(*c == "three");
+
+	// Assigning a value reuses the allocation the escaped references point
+	// into, so it stays unshareable.
+	a = std::string("five");
+	const Shared d = a;
+	CHECK(a.unique() && *d == "five");
+	emplaced = "six";
+	CHECK(*d == "five");
+
+	// A payload from another SharedOptional is shareable again.
+	a = d;
+	CHECK(a.useCount() == 2 && d.useCount() == 2);
+
+	a.reset();
+	CHECK(!a && d.unique());
+}
+
+const std::string* address(const Shared& shared) {
+	return &*shared;
+}
+
+void testUniquePayloadIsReused() {
+	Shared a(std::string("one"));
+	const std::string* block = address(a);
+	a = std::string("two");
+	CHECK(address(a) == block && *address(a) == "two");
+	a = "three";
+	CHECK(address(a) == block);
+	a.emplace(4, 'x');
+	CHECK(address(a) == block && *address(a) == "xxxx");
+
+	// A shared payload is never written; a new one is allocated.
+	const Shared b = Shared(std::string("shared"));
+	Shared c = b;
+	c = std::string("changed");
+	CHECK(*b == "shared" && *address(c) == "changed" && address(c) != address(b));
+}
+
+struct ThrowsOnInt {
+	explicit ThrowsOnInt(int) { throw std::runtime_error("construction failed"); }
+	explicit ThrowsOnInt(const char*) {}
+};
+
+void testEmplaceThrowingOnUniquePayload() {
+	util::SharedOptional<ThrowsOnInt> a(util::inPlace, "ok");
+	CHECK_THROWS(a.emplace(1), std::runtime_error);
+	CHECK(!a);
+
+	util::SharedOptional<ThrowsOnInt> b(util::inPlace, "ok");
+	const util::SharedOptional<ThrowsOnInt> c = b;
+	CHECK_THROWS(b.emplace(1), std::runtime_error);
+	CHECK(b && b.useCount() == 2);
+}
+
+void testEmplaceDoesNotTouchSharedPayload() {
+	Shared a(std::string("x"));
+	const Shared b = a;
+	a.emplace(3, 'y');
+	CHECK(*a == "yyy" && *b == "x" && b.unique());
+}
+
+void testFromOptional() {
+	const util::Optional<std::string> full("v");
+	CHECK(*Shared(full) == "v");
+	CHECK(!Shared(util::Optional<std::string>()));
+}
+
+void testConcurrentCopies() {
+	const Shared source(std::string("shared"));
+	std::vector<std::thread> threads;
+	for (int t = 0; t != 4; ++t) {
+		threads.emplace_back([&source] {
+			for (int i = 0; i != 10000; ++i) {
+				Shared copy = source;
+				CHECK(*static_cast<const Shared&>(copy) == "shared");
+				if (i % 100 == 0)
+					*copy += "!";
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+	CHECK(source.unique() && *source == "shared");
+}
+
+void testLocal() {
+	util::LocalSharedOptional<int> a(1);
+	util::LocalSharedOptional<int> b = a;
+	CHECK(a.useCount() == 2);
+	*b = 2;
+	CHECK(*static_cast<const util::LocalSharedOptional<int>&>(a) == 1);
+	swap(a, b);
+	CHECK(*static_cast<const util::LocalSharedOptional<int>&>(a) == 2);
+}
+
+} // namespace
+
+int main() {
+	testEmpty();
+	testCopiesShareUntilWritten();
+	testEscapedReferenceIsNotShared();
+	testEmplaceDoesNotTouchSharedPayload();
+	testUniquePayloadIsReused();
+	testEmplaceThrowingOnUniquePayload();
+	testFromOptional();
+	testConcurrentCopies();
+	testLocal();
+	return 0;
+}
@@ -0,0 +1,114 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "OptionalSlab.h"
+
+#include "Check.h"
+
+namespace {
+
+struct Tracked {
+	static int live;
+
+	explicit Tracked(int value) : value(value) { ++live; }
+	Tracked(const Tracked& other) : value(other.value) { ++live; }
+	~Tracked() { --live; }
+
+	int value;
+};
+
+int Tracked::live = 0;
+
+struct ThrowsOnConstruction {
+	explicit ThrowsOnConstruction(bool fail) {
+		if (fail)
+			throw std::runtime_error("construction failed");
+	}
+};
+
+void testInsertEraseFind() {
+	util::OptionalSlab<std::string> slab(3);
+	CHECK(slab.capacity() == 3 && slab.empty());
+
+	const auto a = slab.tryInsert("a");
+	const auto b = slab.tryEmplace(2, 'b');
+	const auto c = slab.tryInsert(std::string("c"));
+	CHECK(a && b && c);
+	CHECK(!slab.tryInsert("d"));
+	CHECK(slab.size() == 3);
+	CHECK(*slab.find(*b) == "bb");
+
+	CHECK(slab.erase(*b));
+	CHECK(!slab.erase(*b));
+	CHECK(!slab.contains(*b) && slab.find(*b) == nullptr);
+
+	// The freed slot is reused, but the old handle stays stale.
+	const auto d = slab.tryInsert("d");
+	CHECK(d && (*d).index == (*b).index && *d != *b);
+	CHECK(!slab.contains(*b) && *slab.find(*d) == "d");
+
+	CHECK(!slab.contains(util::SlabHandle{7, 0}));
+}
+
+void testForEachVisitsLiveInIndexOrder() {
+	util::OptionalSlab<int> slab(130);
+	std::vector<util::SlabHandle> handles;
+	for (int i = 0; i != 130; ++i)
+		handles.push_back(*slab.tryInsert(i));
+	for (int i = 0; i < 130; i += 2)
+		slab.erase(handles[i]);
+
+	std::vector<int> seen;
+	slab.forEach([&seen](util::SlabHandle handle, int& value) {
+		CHECK(handle.index == std::uint32_t(value));
+		seen.push_back(value);
+		value *= 10;
+	});
+	CHECK(seen.size() == 65 && seen.front() == 1 && seen.back() == 129);
+
+	const util::OptionalSlab<int>& constSlab = slab;
+	int sum = 0;
+	constSlab.forEach([&sum](util::SlabHandle, const int& value) { sum += value; });
+	CHECK(sum == 10 * 65 * 65);
+}
+
+void testClearAndDestruction() {
+	{
+		util::OptionalSlab<Tracked> slab(4);
+		const auto a = slab.tryEmplace(1);
+		slab.tryEmplace(2);
+		CHECK(Tracked::live == 2);
+		slab.clear();
+		CHECK(Tracked::live == 0 && slab.empty() && !slab.contains(*a));
+		for (int i = 0; i != 4; ++i)
+			CHECK(slab.tryEmplace(i));
+		CHECK(Tracked::live == 4);
+	}
+	CHECK(Tracked::live == 0);
+}
+
+void testThrowingConstructionKeepsSlot() {
+	util::OptionalSlab<ThrowsOnConstruction> slab(1);
+	CHECK_THROWS(slab.tryEmplace(true), std::runtime_error);
+	CHECK(slab.empty());
+	CHECK(slab.tryEmplace(false));
+}
+
+void testRejectsOversizedCapacity() {
+	CHECK_THROWS(util::OptionalSlab<char>(std::size_t(~std::uint32_t(0))), std::length_error);
+	CHECK(util::OptionalSlab<int>(0).capacity() == 0);
+	CHECK(!util::OptionalSlab<int>(0).tryInsert(1));
+}
+
+} // namespace
+
+int main() {
+	testInsertEraseFind();
+	testForEachVisitsLiveInIndexOrder();
+	testClearAndDestruction();
+	testThrowingConstructionKeepsSlot();
+	testRejectsOversizedCapacity();
+	return 0;
+}